@@ -0,0 +1,269 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <clog/console.h>
+#include <imprint/default_setup.h>
+#include <monotonic-time/monotonic_time.h>
+#include <seer/seer.h>
+#include <stdio.h>
+#include <string.h>
+
+clog_config g_clog;
+char g_clog_temp_str[CLOG_TEMP_STR_SIZE];
+
+#define BENCH_STATE_OCTET_SIZE (1024)
+#define BENCH_MAX_PLAYERS (64)
+#define BENCH_MAX_PAYLOAD_OCTET_SIZE (128)
+#define BENCH_FRAME_COUNT (2000)
+
+typedef struct BenchVm {
+    uint8_t state[BENCH_STATE_OCTET_SIZE];
+    uint8_t authoritativeState[BENCH_STATE_OCTET_SIZE];
+    uint64_t checksum;
+    size_t tickCount;
+} BenchVm;
+
+typedef struct BenchConfig {
+    size_t playerCount;
+    size_t payloadOctetSize;
+    size_t maxTicksFromAuthoritative;
+    size_t authoritativeEveryFrame;
+} BenchConfig;
+
+typedef struct BenchResult {
+    size_t frameCount;
+    size_t predictedTickCount;
+    size_t addPredictedStepCount;
+    size_t authoritativeCount;
+    MonotonicTimeNanoseconds updateTime;
+    MonotonicTimeNanoseconds addPredictedStepTime;
+    MonotonicTimeNanoseconds authoritativeTime;
+} BenchResult;
+
+static void benchCopyFromAuthoritative(void* _self, StepId stepId)
+{
+    (void) stepId;
+    BenchVm* self = (BenchVm*) _self;
+    memcpy(self->state, self->authoritativeState, BENCH_STATE_OCTET_SIZE);
+}
+
+static void benchPredictTick(void* _self, const TransmuteInput* input, StepId stepId)
+{
+    BenchVm* self = (BenchVm*) _self;
+
+    uint64_t sum = stepId;
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        const TransmuteParticipantInput* participantInput = &input->participantInputs[i];
+        const uint8_t* octets = (const uint8_t*) participantInput->input;
+        for (size_t j = 0; j < participantInput->octetSize; ++j) {
+            sum += octets[j];
+        }
+        self->state[(participantInput->participantId * 8U) % BENCH_STATE_OCTET_SIZE] ^= (uint8_t) sum;
+    }
+
+    self->checksum += sum;
+    self->tickCount++;
+}
+
+static void benchPostPredictionTicks(void* _self)
+{
+    (void) _self;
+}
+
+static void benchRun(ImprintDefaultSetup* imprint, const BenchConfig* config, BenchResult* result)
+{
+    static BenchVm vm;
+    memset(&vm, 0, sizeof(vm));
+
+    SeerCallbackObjectVtbl vtbl = {
+        .copyFromAuthoritativeFn = benchCopyFromAuthoritative,
+        .predictionTickFn = benchPredictTick,
+        .postPredictionTicksFn = benchPostPredictionTicks,
+    };
+
+    SeerCallbackObject callbackObject = {.vtbl = &vtbl, .self = &vm};
+
+    Clog seerLog;
+    seerLog.constantPrefix = "seer";
+    seerLog.config = &g_clog;
+
+    SeerSetup setup;
+    seerSetupInit(&setup);
+    setup.allocatorWithFree = &imprint->slabAllocator.info;
+    setup.maxPlayers = config->playerCount;
+    setup.maxStepOctetSizeForSingleParticipant = config->payloadOctetSize;
+    setup.maxTicksFromAuthoritative = config->maxTicksFromAuthoritative;
+    setup.log = seerLog;
+
+    StepId initialStepId = 1000;
+
+    Seer seer;
+    seerInit(&seer, callbackObject, setup, initialStepId);
+
+    static uint8_t payloads[BENCH_MAX_PLAYERS][BENCH_MAX_PAYLOAD_OCTET_SIZE];
+    TransmuteParticipantInput participantInputs[BENCH_MAX_PLAYERS];
+    for (size_t i = 0; i < config->playerCount; ++i) {
+        participantInputs[i].participantId = (uint8_t) (i + 1);
+        participantInputs[i].localPartyId = 0;
+        participantInputs[i].inputType = TransmuteParticipantInputTypeNormal;
+        participantInputs[i].input = payloads[i];
+        participantInputs[i].octetSize = config->payloadOctetSize;
+    }
+
+    TransmuteInput input;
+    input.participantInputs = participantInputs;
+    input.participantCount = config->playerCount;
+
+    // The authoritative state lags behind the predicted head by half the horizon
+    size_t authoritativeLatencyTicks = config->maxTicksFromAuthoritative / 2;
+    StepId nextPredictedStepId = initialStepId;
+
+    memset(result, 0, sizeof(*result));
+
+    for (size_t frame = 0; frame < BENCH_FRAME_COUNT; ++frame) {
+        for (size_t i = 0; i < config->playerCount; ++i) {
+            payloads[i][0] = (uint8_t) (frame + i);
+        }
+
+        MonotonicTimeNanoseconds before = monotonicTimeNanosecondsNow();
+        int addResult = seerAddPredictedStep(&seer, &input, nextPredictedStepId);
+        result->addPredictedStepTime += monotonicTimeNanosecondsNow() - before;
+        if (addResult >= 0) {
+            nextPredictedStepId++;
+            result->addPredictedStepCount++;
+        }
+
+        if ((frame % config->authoritativeEveryFrame) == 0 && nextPredictedStepId > initialStepId +
+                                                                                        authoritativeLatencyTicks) {
+            StepId authoritativeStepId = (StepId) (nextPredictedStepId - authoritativeLatencyTicks);
+            if (authoritativeStepId > seer.authoritativeStepId) {
+                before = monotonicTimeNanosecondsNow();
+                seerAuthoritativeGotNewState(&seer, authoritativeStepId);
+                result->authoritativeTime += monotonicTimeNanosecondsNow() - before;
+                result->authoritativeCount++;
+            }
+        }
+
+        size_t tickCountBefore = vm.tickCount;
+        before = monotonicTimeNanosecondsNow();
+        seerUpdate(&seer);
+        result->updateTime += monotonicTimeNanosecondsNow() - before;
+        result->predictedTickCount += vm.tickCount - tickCountBefore;
+    }
+
+    result->frameCount = BENCH_FRAME_COUNT;
+
+    seerDestroy(&seer);
+}
+
+static double benchNsPer(MonotonicTimeNanoseconds time, size_t count)
+{
+    return count == 0 ? 0.0 : (double) time / (double) count;
+}
+
+static void benchWriteHeader(FILE* fp, int useJson)
+{
+    if (useJson) {
+        fprintf(fp, "[\n");
+        return;
+    }
+
+    fprintf(fp, "players,payloadOctets,maxTicksFromAuthoritative,authoritativeEveryFrame,frames,predictedTicks,"
+                "updateNsPerTick,ticksPerSecond,addPredictedStepNsPerCall,authoritativeGotNewStateNsPerCall\n");
+}
+
+static void benchWriteResult(FILE* fp, int useJson, int isFirst, const BenchConfig* config,
+                             const BenchResult* result)
+{
+    double updateNsPerTick = benchNsPer(result->updateTime, result->predictedTickCount);
+    double ticksPerSecond = updateNsPerTick > 0.0 ? 1000000000.0 / updateNsPerTick : 0.0;
+    double addNsPerCall = benchNsPer(result->addPredictedStepTime, result->addPredictedStepCount);
+    double authoritativeNsPerCall = benchNsPer(result->authoritativeTime, result->authoritativeCount);
+
+    if (useJson) {
+        fprintf(fp,
+                "%s  {\"players\": %zu, \"payloadOctets\": %zu, \"maxTicksFromAuthoritative\": %zu, "
+                "\"authoritativeEveryFrame\": %zu, \"frames\": %zu, \"predictedTicks\": %zu, "
+                "\"updateNsPerTick\": %.1f, \"ticksPerSecond\": %.0f, \"addPredictedStepNsPerCall\": %.1f, "
+                "\"authoritativeGotNewStateNsPerCall\": %.1f}",
+                isFirst ? "" : ",\n", config->playerCount, config->payloadOctetSize,
+                config->maxTicksFromAuthoritative, config->authoritativeEveryFrame, result->frameCount,
+                result->predictedTickCount, updateNsPerTick, ticksPerSecond, addNsPerCall, authoritativeNsPerCall);
+        return;
+    }
+
+    fprintf(fp, "%zu,%zu,%zu,%zu,%zu,%zu,%.1f,%.0f,%.1f,%.1f\n", config->playerCount, config->payloadOctetSize,
+            config->maxTicksFromAuthoritative, config->authoritativeEveryFrame, result->frameCount,
+            result->predictedTickCount, updateNsPerTick, ticksPerSecond, addNsPerCall, authoritativeNsPerCall);
+}
+
+/// Usage: seer_bench [--json] [output file]
+/// Writes one CSV line (or JSON object) for each combination of player count, payload size, horizon and
+/// authoritative arrival rate.
+int main(int argc, const char* const argv[])
+{
+    g_clog.log = clog_console;
+    g_clog.level = CLOG_TYPE_WARN;
+
+    int useJson = 0;
+    const char* outputFilename = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0) {
+            useJson = 1;
+        } else {
+            outputFilename = argv[i];
+        }
+    }
+
+    FILE* fp = stdout;
+    if (outputFilename != 0) {
+        fp = fopen(outputFilename, "w");
+        if (fp == 0) {
+            CLOG_ERROR("could not open '%s' for writing", outputFilename)
+            return -1;
+        }
+    }
+
+    static const size_t playerCounts[] = {1, 4, 16, 64};
+    static const size_t payloadOctetSizes[] = {8, 32, 128};
+    static const size_t horizons[] = {10, 60, 240};
+    static const size_t authoritativeEveryFrames[] = {1, 3};
+
+    ImprintDefaultSetup imprint;
+    imprintDefaultSetupInit(&imprint, 256 * 1024 * 1024);
+
+    benchWriteHeader(fp, useJson);
+
+    int isFirst = 1;
+    for (size_t p = 0; p < sizeof(playerCounts) / sizeof(playerCounts[0]); ++p) {
+        for (size_t o = 0; o < sizeof(payloadOctetSizes) / sizeof(payloadOctetSizes[0]); ++o) {
+            for (size_t h = 0; h < sizeof(horizons) / sizeof(horizons[0]); ++h) {
+                for (size_t a = 0; a < sizeof(authoritativeEveryFrames) / sizeof(authoritativeEveryFrames[0]);
+                     ++a) {
+                    BenchConfig config;
+                    config.playerCount = playerCounts[p];
+                    config.payloadOctetSize = payloadOctetSizes[o];
+                    config.maxTicksFromAuthoritative = horizons[h];
+                    config.authoritativeEveryFrame = authoritativeEveryFrames[a];
+
+                    BenchResult result;
+                    benchRun(&imprint, &config, &result);
+                    benchWriteResult(fp, useJson, isFirst, &config, &result);
+                    isFirst = 0;
+                }
+            }
+        }
+    }
+
+    if (useJson) {
+        fprintf(fp, "\n]\n");
+    }
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_CAPTURE_H
+#define SEER_CAPTURE_H
+
+#include <monotonic-time/monotonic_time.h>
+#include <nimble-steps/steps.h>
+#include <seer/predicted_steps.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <transmute/transmute.h>
+
+struct Seer;
+
+#define SEER_PLAYER_MAX_PARTICIPANT_COUNT (64)
+
+typedef enum SeerCaptureRecordType {
+    SeerCaptureRecordTypePredictedStep = 1,
+    SeerCaptureRecordTypeConfirmedStep,
+    SeerCaptureRecordTypeAuthoritativeState,
+    SeerCaptureRecordTypeUpdate,
+    SeerCaptureRecordTypePredictedInput,
+} SeerCaptureRecordType;
+
+/// Writes the authoritative state for stepId into target.
+/// @return octet count written, or negative if the state is not available
+typedef int (*SeerRecorderSaveAuthoritativeFn)(void* self, uint8_t* target, size_t maxOctetCount, StepId stepId);
+
+/// Records the calls to a Seer into a caller provided buffer (which can be a memory mapped file), so the session can
+/// be played back later with SeerPlayer. Each record is a type, StepId, time since the start of the capture and an
+/// optional payload.
+typedef struct SeerRecorder {
+    uint8_t* octets;
+    size_t maxOctetCount;
+    size_t octetCount;
+    MonotonicTimeNanoseconds startTime;
+    bool hasStartTime;
+    size_t droppedRecordCount;
+    SeerRecorderSaveAuthoritativeFn saveAuthoritativeFn;
+    void* saveAuthoritativeSelf;
+} SeerRecorder;
+
+void seerRecorderInit(SeerRecorder* self, uint8_t* octets, size_t maxOctetCount,
+                      SeerRecorderSaveAuthoritativeFn saveAuthoritativeFn, void* saveAuthoritativeSelf);
+void seerRecorderAddStep(SeerRecorder* self, SeerCaptureRecordType type, const uint8_t* combinedStep,
+                         size_t octetCount, StepId stepId);
+void seerRecorderAddInput(SeerRecorder* self, const TransmuteInput* input, StepId stepId);
+void seerRecorderAddGather(SeerRecorder* self, const SeerGatherParticipant* participants, size_t participantCount,
+                           StepId stepId);
+void seerRecorderAuthoritativeGotNewState(SeerRecorder* self, StepId stepId);
+void seerRecorderUpdate(SeerRecorder* self, StepId stepId, bool isOutOfBudget);
+int seerRecorderWriteToFile(const SeerRecorder* self, const char* filename);
+
+/// Loads the authoritative state for stepId, before Seer is told that it has arrived.
+typedef void (*SeerPlayerLoadAuthoritativeFn)(void* self, const uint8_t* source, size_t octetCount, StepId stepId);
+
+/// Plays back a capture from SeerRecorder into a Seer, in the same order as it was recorded.
+typedef struct SeerPlayer {
+    const uint8_t* octets;
+    size_t octetCount;
+    size_t position;
+    MonotonicTimeNanoseconds time;
+    SeerPlayerLoadAuthoritativeFn loadAuthoritativeFn;
+    void* loadAuthoritativeSelf;
+    TransmuteParticipantInput participantInputs[SEER_PLAYER_MAX_PARTICIPANT_COUNT];
+} SeerPlayer;
+
+int seerPlayerInit(SeerPlayer* self, const uint8_t* octets, size_t octetCount,
+                   SeerPlayerLoadAuthoritativeFn loadAuthoritativeFn, void* loadAuthoritativeSelf);
+int seerPlayerUpdate(SeerPlayer* self, struct Seer* seer);
+
+#endif
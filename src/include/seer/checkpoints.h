@@ -0,0 +1,42 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_CHECKPOINTS_H
+#define SEER_CHECKPOINTS_H
+
+#include <nimble-steps/steps.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+
+typedef struct SeerCheckpoint {
+    StepId stepId;
+    uint8_t* octets;
+    size_t octetCount;
+    bool isValid;
+} SeerCheckpoint;
+
+/// Preallocated pool of predicted state snapshots, one for every `interval` ticks.
+typedef struct SeerCheckpoints {
+    SeerCheckpoint* checkpoints;
+    size_t capacity;
+    size_t interval;
+    uint8_t* octets;
+    size_t maxOctetSize;
+} SeerCheckpoints;
+
+void seerCheckpointsInit(SeerCheckpoints* self, struct ImprintAllocator* allocator, size_t maxTicks, size_t interval,
+                         size_t maxOctetSize);
+void seerCheckpointsDestroy(SeerCheckpoints* self, struct ImprintAllocatorWithFree* allocatorWithFree);
+bool seerCheckpointsIsEnabled(const SeerCheckpoints* self);
+bool seerCheckpointsShouldSave(const SeerCheckpoints* self, StepId stepId);
+SeerCheckpoint* seerCheckpointsSlot(SeerCheckpoints* self, StepId stepId);
+const SeerCheckpoint* seerCheckpointsFindNearest(const SeerCheckpoints* self, StepId stepId, StepId lowestStepId);
+void seerCheckpointsInvalidateAfter(SeerCheckpoints* self, StepId stepId);
+void seerCheckpointsInvalidateAll(SeerCheckpoints* self);
+
+#endif
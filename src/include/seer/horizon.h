@@ -0,0 +1,39 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_HORIZON_H
+#define SEER_HORIZON_H
+
+#include <monotonic-time/monotonic_time.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SEER_ADAPTIVE_HORIZON_FRACTION_BITS (8)
+
+typedef struct SeerAdaptiveHorizonSetup {
+    size_t minTicks;
+    size_t maxTicks; // clamped to maxTicksFromAuthoritative
+    size_t marginTicks; // added to the measured authoritative latency
+    MonotonicTimeNanoseconds maxPredictionTimePerUpdate; // zero to not limit the horizon by the tick cost
+} SeerAdaptiveHorizonSetup;
+
+/// Prediction horizon that follows how many ticks the authoritative states lag behind the predicted steps and how
+/// long a predicted tick takes, both as exponentially weighted moving averages.
+typedef struct SeerAdaptiveHorizon {
+    SeerAdaptiveHorizonSetup setup;
+    bool isEnabled;
+    int64_t latencyTicksAverage; // fixed point, see SEER_ADAPTIVE_HORIZON_FRACTION_BITS
+    bool hasLatency;
+    MonotonicTimeNanoseconds tickCostAverage;
+    bool hasTickCost;
+    size_t horizonTicks;
+} SeerAdaptiveHorizon;
+
+void seerAdaptiveHorizonInit(SeerAdaptiveHorizon* self, size_t maxTicks);
+void seerAdaptiveHorizonSet(SeerAdaptiveHorizon* self, SeerAdaptiveHorizonSetup setup);
+void seerAdaptiveHorizonAddLatency(SeerAdaptiveHorizon* self, size_t latencyTicks);
+void seerAdaptiveHorizonAddTickCost(SeerAdaptiveHorizon* self, MonotonicTimeNanoseconds tickCost);
+
+#endif
@@ -0,0 +1,64 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_INPUT_PREDICTOR_H
+#define SEER_INPUT_PREDICTOR_H
+
+#include <nimble-steps/steps.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <transmute/transmute.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+
+typedef enum SeerInputPredictorMode {
+    SeerInputPredictorModeNone, // only use the predicted steps that were added
+    SeerInputPredictorModeRepeatLast, // repeat the last confirmed input
+    SeerInputPredictorModeDecayToNeutral, // repeat the last confirmed input, then switch to an all zero input
+    SeerInputPredictorModeCustom, // ask predictParticipantInputFn
+} SeerInputPredictorMode;
+
+/// Writes a predicted input for a participant, based on the last confirmed input for that participant.
+/// ticksSinceConfirmed is one for the tick directly after the confirmed one.
+/// @return octet count written to target, or negative if no input could be predicted
+typedef int (*SeerPredictParticipantInputFn)(void* self, const TransmuteParticipantInput* lastConfirmed,
+                                             size_t ticksSinceConfirmed, uint8_t* target, size_t maxOctetCount,
+                                             StepId tickId);
+
+typedef struct SeerInputPredictorSetup {
+    SeerInputPredictorMode mode;
+    size_t ticksUntilNeutral; // only for SeerInputPredictorModeDecayToNeutral
+    SeerPredictParticipantInputFn predictParticipantInputFn; // only for SeerInputPredictorModeCustom
+    void* predictParticipantInputSelf;
+} SeerInputPredictorSetup;
+
+/// Synthesizes the inputs for participants that are missing in a predicted step (or for the whole step if it is
+/// missing), from the last confirmed input of each participant.
+typedef struct SeerInputPredictor {
+    SeerInputPredictorSetup setup;
+    size_t maxParticipantCount;
+    size_t maxOctetSizeForSingleParticipant;
+    size_t payloadStride;
+    uint8_t* payloadsAllocation;
+    TransmuteInput lastConfirmed;
+    uint8_t* lastConfirmedPayloads;
+    StepId lastConfirmedStepId;
+    bool hasLastConfirmed;
+    TransmuteInput predicted;
+    uint8_t* predictedPayloads;
+} SeerInputPredictor;
+
+void seerInputPredictorInit(SeerInputPredictor* self, struct ImprintAllocator* allocator, size_t maxParticipantCount,
+                            size_t maxOctetSizeForSingleParticipant, size_t payloadAlignment);
+void seerInputPredictorDestroy(SeerInputPredictor* self, struct ImprintAllocatorWithFree* allocatorWithFree);
+void seerInputPredictorReset(SeerInputPredictor* self);
+void seerInputPredictorSet(SeerInputPredictor* self, SeerInputPredictorSetup setup);
+bool seerInputPredictorIsEnabled(const SeerInputPredictor* self);
+void seerInputPredictorConfirmed(SeerInputPredictor* self, const TransmuteInput* input, StepId tickId);
+const TransmuteInput* seerInputPredictorPredict(SeerInputPredictor* self, const TransmuteInput* predictedStep,
+                                                StepId tickId, size_t* synthesizedCount);
+
+#endif
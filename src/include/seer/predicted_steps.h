@@ -0,0 +1,89 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_PREDICTED_STEPS_H
+#define SEER_PREDICTED_STEPS_H
+
+#include <clog/clog.h>
+#include <nimble-steps/steps.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <transmute/transmute.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+
+/// A part of a participant payload, see seerAddPredictedStepGather()
+typedef struct SeerPayloadFragment {
+    const void* octets;
+    size_t octetCount;
+} SeerPayloadFragment;
+
+typedef struct SeerGatherParticipant {
+    uint8_t participantId;
+    uint8_t localPartyId;
+    TransmuteParticipantInputType inputType;
+    const SeerPayloadFragment* fragments;
+    size_t fragmentCount;
+} SeerGatherParticipant;
+
+/// Struct of arrays view of the participant inputs for one predicted step, see seerGetPredictedInputSoa()
+typedef struct SeerParticipantInputsSoa {
+    const uint8_t* participantIds;
+    const TransmuteParticipantInputType* inputTypes;
+    const void* const* payloads;
+    const size_t* octetSizes;
+    size_t participantCount;
+} SeerParticipantInputsSoa;
+
+/// Ring of already decoded predicted inputs, indexed by StepId.
+/// The capacity is a power of two, so the slot for a StepId is found by masking the lowest bits.
+/// The participant payloads are stored in a contiguous arena, one fixed size slice for each step. Each payload starts
+/// at a multiple of payloadAlignment.
+/// Optionally the participant inputs are also stored as separate arrays for each field, maxParticipantCount entries for
+/// each step.
+typedef struct SeerPredictedSteps {
+    TransmuteInput* inputs;
+    TransmuteParticipantInput* participantInputs;
+    StepId* stepIds;
+    uint8_t* rawOctets; // the serialized combined step of each step, maxRawOctetCount for each step
+    size_t* rawOctetCounts; // zero if the step was not written from a serialized combined step
+    size_t maxRawOctetCount;
+    uint8_t* payloadArena;
+    uint8_t* payloadArenaAllocation;
+    size_t payloadAlignment;
+    uint8_t* soaParticipantIds;
+    TransmuteParticipantInputType* soaInputTypes;
+    const void** soaPayloads;
+    size_t* soaOctetSizes;
+    bool hasSoa;
+    size_t capacity;
+    size_t indexMask;
+    size_t maxParticipantCount;
+    size_t maxPayloadOctetCountPerStep;
+    StepId tailStepId;
+    StepId headStepId;
+    size_t stepsCount;
+    Clog log;
+} SeerPredictedSteps;
+
+void seerPredictedStepsInit(SeerPredictedSteps* self, struct ImprintAllocator* allocator, size_t capacity,
+                            size_t maxParticipantCount, size_t maxOctetSizeForSingleParticipant,
+                            size_t payloadAlignment, size_t maxRawOctetCount, bool useSoa, Clog log);
+void seerPredictedStepsDestroy(SeerPredictedSteps* self, struct ImprintAllocatorWithFree* allocatorWithFree);
+void seerPredictedStepsReInit(SeerPredictedSteps* self, StepId stepId);
+int seerPredictedStepsWrite(SeerPredictedSteps* self, const TransmuteInput* input, StepId stepId);
+int seerPredictedStepsWriteGather(SeerPredictedSteps* self, const SeerGatherParticipant* participants,
+                                  size_t participantCount, StepId stepId);
+const TransmuteInput* seerPredictedStepsGet(const SeerPredictedSteps* self, StepId stepId);
+int seerPredictedStepsGetSoa(const SeerPredictedSteps* self, StepId stepId, SeerParticipantInputsSoa* target);
+size_t seerPredictedStepsGetConsecutive(const SeerPredictedSteps* self, StepId stepId, size_t maxCount,
+                                        const TransmuteInput** inputs);
+int seerPredictedStepsDiscardUpTo(SeerPredictedSteps* self, StepId stepId);
+void seerPredictedStepsSetRaw(SeerPredictedSteps* self, StepId stepId, const uint8_t* octets, size_t octetCount);
+bool seerPredictedStepsHasRaw(const SeerPredictedSteps* self, StepId stepId, const uint8_t* octets, size_t octetCount);
+bool seerTransmuteInputEqual(const TransmuteInput* a, const TransmuteInput* b);
+
+#endif
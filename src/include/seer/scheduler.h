@@ -0,0 +1,73 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_SCHEDULER_H
+#define SEER_SCHEDULER_H
+
+#include <monotonic-time/monotonic_time.h>
+#include <seer/seer.h>
+#include <seer/thread.h>
+#include <stdbool.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+struct SeerScheduler;
+
+typedef struct SeerSchedulerSession {
+    Seer* seer;
+    int lastUpdateResult;
+    size_t updateCount;
+    MonotonicTimeNanoseconds lastUpdateTime;
+    MonotonicTimeNanoseconds maxUpdateTime;
+    MonotonicTimeNanoseconds totalUpdateTime;
+} SeerSchedulerSession;
+
+/// Session indices for one worker. The owner takes from the tail, other workers steal from the head.
+typedef struct SeerSchedulerQueue {
+    SeerMutex mutex;
+    size_t* sessionIndices;
+    size_t head;
+    size_t tail;
+} SeerSchedulerQueue;
+
+typedef struct SeerSchedulerWorker {
+    struct SeerScheduler* scheduler;
+    size_t index;
+    SeerThread thread;
+    SeerSchedulerQueue queue;
+    size_t stolenCount;
+} SeerSchedulerWorker;
+
+/// Runs seerUpdate() for many Seer sessions on a pool of worker threads.
+/// Each update the sessions are spread evenly over the worker queues, and a worker that runs out of sessions steals
+/// from the others. All callbacks of a Seer are called on one of the worker threads, but not always the same one.
+typedef struct SeerScheduler {
+    struct ImprintAllocatorWithFree* allocatorWithFree;
+    SeerSchedulerSession* sessions;
+    size_t sessionCount;
+    size_t maxSessionCount;
+    SeerSchedulerWorker* workers;
+    size_t workerCount;
+    size_t startedWorkerCount; // worker threads that are started and must be joined
+    SeerMutex mutex;
+    SeerCondition wakeUp;
+    SeerCondition allDone;
+    size_t generation;
+    size_t remainingSessionCount;
+    bool stopRequested;
+    bool isRunning;
+    Clog log;
+} SeerScheduler;
+
+void seerSchedulerInit(SeerScheduler* self, struct ImprintAllocator* allocator,
+                       struct ImprintAllocatorWithFree* allocatorWithFree, size_t maxSessionCount, size_t workerCount,
+                       Clog log);
+void seerSchedulerDestroy(SeerScheduler* self);
+int seerSchedulerStart(SeerScheduler* self);
+void seerSchedulerStop(SeerScheduler* self);
+int seerSchedulerAdd(SeerScheduler* self, Seer* seer);
+int seerSchedulerRemove(SeerScheduler* self, const Seer* seer);
+void seerSchedulerUpdate(SeerScheduler* self);
+
+#endif
@@ -5,22 +5,54 @@
 #ifndef SEER_H
 #define SEER_H
 
+#include <monotonic-time/monotonic_time.h>
 #include <nimble-steps/steps.h>
+#include <seer/capture.h>
+#include <seer/checkpoints.h>
+#include <seer/horizon.h>
+#include <seer/input_predictor.h>
+#include <seer/predicted_steps.h>
+#include <seer/speculation.h>
+#include <seer/spsc_queue.h>
+#include <seer/stats.h>
+#include <seer/trace.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <transmute/transmute.h>
 
 struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
 
 typedef void (*SeerPredictionCopyFromAuthoritativeFn)(void* self, StepId tickId);
+/// The input points directly into the predicted steps ring and stays valid until the step is discarded by a newer
+/// authoritative state, unless the inputs were synthesized by the input predictor. Repeated participant payloads are
+/// shared between consecutive steps, and stay valid until the next authoritative state discards steps.
 typedef void (*SeerPredictionTickFn)(void* self, const TransmuteInput* input, StepId tickId);
+typedef void (*SeerPredictionTicksFn)(void* self, const TransmuteInput* inputs, size_t count, StepId firstTickId);
 typedef void (*SeerPredictionPostPredictionTicksFn)(void* self);
+typedef uint64_t (*SeerStateHashFn)(void* self, StepId tickId);
+typedef int (*SeerSaveSnapshotFn)(void* self, uint8_t* target, size_t maxOctetCount, StepId tickId);
+typedef void (*SeerLoadSnapshotFn)(void* self, const uint8_t* source, size_t octetCount, StepId tickId);
+/// The branch callbacks are called from seerUpdateSpeculativeBranch(), possibly on several threads at the same time,
+/// but never for the same branchIndex at the same time. Each branch needs its own simulation context.
+typedef void (*SeerBranchCopyFromAuthoritativeFn)(void* self, size_t branchIndex, StepId tickId);
+typedef void (*SeerBranchTickFn)(void* self, size_t branchIndex, const TransmuteInput* input, StepId tickId);
+/// Makes the simulation context of the branch the predicted one, typically by swapping pointers.
+typedef void (*SeerSelectBranchFn)(void* self, size_t branchIndex, StepId tickId);
 
 typedef struct SeerCallbackObjectVtbl {
     SeerPredictionCopyFromAuthoritativeFn copyFromAuthoritativeFn;
     SeerPredictionTickFn predictionTickFn;
+    SeerPredictionTicksFn predictionTicksFn; // optional, called instead of predictionTickFn for consecutive ticks
     SeerPredictionPostPredictionTicksFn postPredictionTicksFn;
+    SeerStateHashFn predictedStateHashFn; // optional, hash of the current predicted TransmuteState
+    SeerStateHashFn authoritativeStateHashFn; // optional, hash of the authoritative TransmuteState
+    SeerSaveSnapshotFn saveSnapshotFn; // needed if checkpointInterval is set
+    SeerLoadSnapshotFn loadSnapshotFn; // needed if checkpointInterval is set
+    SeerBranchCopyFromAuthoritativeFn branchCopyFromAuthoritativeFn; // needed for seerSetSpeculation()
+    SeerBranchTickFn branchTickFn; // needed for seerSetSpeculation()
+    SeerSelectBranchFn selectBranchFn; // needed for seerSetSpeculation()
 } SeerCallbackObjectVtbl;
 
 typedef struct SeerCallbackObject {
@@ -30,31 +62,78 @@ typedef struct SeerCallbackObject {
 
 typedef struct Seer {
     SeerCallbackObject callbackObject;
+    struct ImprintAllocatorWithFree* allocatorWithFree;
     size_t maxPlayerCount;
-    uint8_t* readTempBuffer;
-    size_t readTempBufferSize;
-    NbsSteps predictedSteps;
+    SeerPredictedSteps predictedSteps;
     TransmuteInput cachedTransmuteInput;
     size_t maxPredictionTicksFromAuthoritative;
     StepId stepId;
     StepId maxPredictionTickId;
+    StepId authoritativeStepId;
+    StepId pendingAuthoritativeStepId;
+    bool hasPendingAuthoritativeStepId;
+    StepId confirmedStepId;
+    StepId firstMispredictedStepId;
+    bool hasMispredictedStep;
+    StepId firstReplacedStepId;
+    bool hasReplacedStep;
+    SeerCheckpoints checkpoints;
+    SeerInputPredictor inputPredictor;
+    SeerAdaptiveHorizon adaptiveHorizon;
+    SeerSpeculation speculation;
+    SeerSpscQueue enqueuedSteps;
+    SeerSpscQueue enqueuedAuthoritativeStepIds;
+    size_t maxCombinedStepOctetCount;
+    uint64_t* predictedStateHashes;
+    StepId* predictedStateHashStepIds;
+    size_t predictedStateHashCapacity;
+    SeerStats* stats;
+    SeerTrace* trace;
+    SeerRecorder* recorder;
     Clog log;
 } Seer;
 
+/// Use seerSetupInit() before setting the fields, so the optional fields that are not set are disabled.
 typedef struct SeerSetup {
     struct ImprintAllocator* allocator;
+    struct ImprintAllocatorWithFree* allocatorWithFree; // optional, used instead of allocator, freed in seerDestroy()
     size_t maxStepOctetSizeForSingleParticipant;
     size_t maxPlayers;
     size_t maxTicksFromAuthoritative;
+    size_t checkpointInterval; // zero to disable checkpoints
+    size_t maxCheckpointOctetSize;
+    size_t maxEnqueuedSteps; // zero if the seerEnqueue functions are not used
+    size_t payloadAlignment; // zero, or a power of two that every participant payload given to the callbacks starts at
+    size_t maxSpeculativeBranchCount; // zero if seerSetSpeculation() is not used
+    bool useParticipantInputsSoa; // also store the predicted steps as struct of arrays, see seerGetPredictedInputSoa()
     Clog log;
 } SeerSetup;
 
+void seerSetupInit(SeerSetup* self);
 void seerInit(Seer* self, SeerCallbackObject callbackObject, SeerSetup setup, StepId stepId);
 void seerDestroy(Seer* self);
+void seerReset(Seer* self, StepId stepId);
+void seerSetStats(Seer* self, SeerStats* stats);
+void seerSetTrace(Seer* self, SeerTrace* trace);
+void seerSetRecorder(Seer* self, SeerRecorder* recorder);
+void seerSetInputPredictor(Seer* self, SeerInputPredictorSetup setup);
+void seerSetAdaptiveHorizon(Seer* self, SeerAdaptiveHorizonSetup setup);
+int seerSetSpeculation(Seer* self, uint8_t participantId, const SeerPayloadFragment* hypotheses, size_t branchCount);
+int seerUpdateSpeculativeBranch(Seer* self, size_t branchIndex);
+int seerUpdateSpeculativeBranches(Seer* self);
 int seerUpdate(Seer* self);
+int seerUpdateWithBudget(Seer* self, MonotonicTimeNanoseconds budget);
+int seerUpdateUntilStepId(Seer* self, StepId stopStepId);
 void seerAuthoritativeGotNewState(Seer* self, StepId stepId);
 bool seerShouldAddPredictedStepThisTick(const Seer* self);
 int seerAddPredictedStep(Seer* self, const TransmuteInput* input, StepId tickId);
+int seerAddPredictedStepGather(Seer* self, const SeerGatherParticipant* participants, size_t participantCount,
+                               StepId tickId);
 int seerAddPredictedStepRaw(Seer* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId);
+int seerEnqueuePredictedStepRaw(Seer* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId);
+int seerEnqueueAuthoritativeGotNewState(Seer* self, StepId stepId);
+const TransmuteInput* seerGetPredictedInput(const Seer* self, StepId tickId);
+int seerGetPredictedInputSoa(const Seer* self, StepId tickId, SeerParticipantInputsSoa* target);
+int seerConfirmStepRaw(Seer* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId);
 
 #endif
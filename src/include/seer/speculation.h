@@ -0,0 +1,69 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_SPECULATION_H
+#define SEER_SPECULATION_H
+
+#include <nimble-steps/steps.h>
+#include <seer/predicted_steps.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <transmute/transmute.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+
+/// One alternative future, simulated from the authoritative state with a hypothesized input for the speculated
+/// participant, and the predicted steps for all the other participants.
+typedef struct SeerSpeculativeBranch {
+    TransmuteInput input;
+    const uint8_t* hypothesis;
+    size_t hypothesisOctetCount;
+    StepId startStepId;
+    StepId stepId;
+    bool isStarted;
+    StepId firstMismatchStepId;
+    StepId lastMismatchStepId;
+    bool hasMismatch;
+} SeerSpeculativeBranch;
+
+/// Keeps track of which branches still agree with the confirmed inputs.
+/// A branch is only usable if the speculated participant sent its hypothesis for every confirmed tick, and all the
+/// other participants sent the inputs that are in the predicted steps.
+typedef struct SeerSpeculation {
+    SeerSpeculativeBranch* branches;
+    size_t maxBranchCount;
+    size_t branchCount;
+    uint8_t participantId;
+    size_t maxParticipantCount;
+    size_t maxOctetSizeForSingleParticipant;
+    uint8_t* hypothesisOctets;
+    StepId firstOtherMismatchStepId;
+    StepId lastOtherMismatchStepId;
+    bool hasOtherMismatch;
+    size_t committedBranchIndex;
+    StepId committedFromStepId;
+    StepId committedUntilStepId;
+} SeerSpeculation;
+
+void seerSpeculationInit(SeerSpeculation* self, struct ImprintAllocator* allocator, size_t maxBranchCount,
+                         size_t maxParticipantCount, size_t maxOctetSizeForSingleParticipant);
+void seerSpeculationDestroy(SeerSpeculation* self, struct ImprintAllocatorWithFree* allocatorWithFree);
+void seerSpeculationReset(SeerSpeculation* self);
+int seerSpeculationSet(SeerSpeculation* self, uint8_t participantId, const SeerPayloadFragment* hypotheses,
+                       size_t branchCount);
+bool seerSpeculationIsEnabled(const SeerSpeculation* self);
+void seerSpeculationRestart(SeerSpeculation* self, StepId authoritativeStepId);
+const TransmuteInput* seerSpeculationBranchInput(SeerSpeculation* self, size_t branchIndex,
+                                                 const TransmuteInput* predictedInput);
+int seerSpeculationConfirmed(SeerSpeculation* self, const TransmuteInput* predictedInput,
+                             const TransmuteInput* confirmedInput, StepId tickId);
+int seerSpeculationFindMatchingBranch(const SeerSpeculation* self, StepId authoritativeStepId,
+                                      StepId previousAuthoritativeStepId);
+bool seerSpeculationCommit(SeerSpeculation* self, size_t branchIndex, StepId authoritativeStepId);
+void seerSpeculationStepReplaced(SeerSpeculation* self, StepId tickId);
+void seerSpeculationTruncateCommitted(SeerSpeculation* self, StepId stepId);
+
+#endif
@@ -0,0 +1,32 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_SPSC_QUEUE_H
+#define SEER_SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+
+/// Lock-free queue of fixed size elements, for exactly one producer thread and one consumer thread.
+typedef struct SeerSpscQueue {
+    uint8_t* octets;
+    size_t elementOctetSize;
+    size_t capacity;
+    size_t writeCount;
+    size_t readCount;
+} SeerSpscQueue;
+
+void seerSpscQueueInit(SeerSpscQueue* self, struct ImprintAllocator* allocator, size_t capacity,
+                       size_t elementOctetSize);
+void seerSpscQueueDestroy(SeerSpscQueue* self, struct ImprintAllocatorWithFree* allocatorWithFree);
+void seerSpscQueueReset(SeerSpscQueue* self);
+void* seerSpscQueuePrepareWrite(SeerSpscQueue* self);
+void seerSpscQueueCommitWrite(SeerSpscQueue* self);
+const void* seerSpscQueuePeek(SeerSpscQueue* self);
+void seerSpscQueuePop(SeerSpscQueue* self);
+
+#endif
@@ -0,0 +1,48 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_STATS_H
+#define SEER_STATS_H
+
+#include <monotonic-time/monotonic_time.h>
+#include <stddef.h>
+
+#define SEER_STATS_RESIMULATED_TICKS_HISTOGRAM_SIZE (32)
+
+typedef struct SeerStatsCallback {
+    size_t callCount;
+    MonotonicTimeNanoseconds totalTime;
+} SeerStatsCallback;
+
+/// Counters that Seer fills in when they are set with seerSetStats().
+/// resimulatedTicksHistogram[n] counts the authoritative updates that required n already predicted ticks to be
+/// simulated again. The last bucket also counts all updates with more ticks than that.
+typedef struct SeerStats {
+    size_t predictedTickCount;
+    size_t authoritativeUpdateCount;
+    size_t coalescedAuthoritativeCount;
+    size_t resimulatedTicksHistogram[SEER_STATS_RESIMULATED_TICKS_HISTOGRAM_SIZE];
+    size_t horizonCapHitCount;
+    size_t missingInputStopCount;
+    size_t synthesizedInputCount;
+    size_t checkpointRestoreCount;
+    size_t speculativeBranchCommitCount;
+    size_t deserializedOctetCount;
+    size_t duplicateStepCount; // serialized steps that were already stored and not decoded again
+    size_t storedPayloadOctetCount;
+    size_t sharedPayloadOctetCount; // part of storedPayloadOctetCount that was shared with the step before
+    SeerStatsCallback copyFromAuthoritative;
+    SeerStatsCallback predictionTick;
+    SeerStatsCallback postPredictionTicks;
+    SeerStatsCallback predictedStateHash;
+    SeerStatsCallback authoritativeStateHash;
+    SeerStatsCallback saveSnapshot;
+    SeerStatsCallback loadSnapshot;
+} SeerStats;
+
+void seerStatsInit(SeerStats* self);
+void seerStatsAddResimulatedTicks(SeerStats* self, size_t resimulatedTickCount);
+void seerStatsCallbackAdd(SeerStatsCallback* self, MonotonicTimeNanoseconds startedAt);
+
+#endif
@@ -0,0 +1,57 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_THREAD_H
+#define SEER_THREAD_H
+
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+typedef void (*SeerThreadFn)(void* arg);
+
+typedef struct SeerThread {
+#if defined _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    SeerThreadFn fn;
+    void* arg;
+} SeerThread;
+
+typedef struct SeerMutex {
+#if defined _WIN32
+    CRITICAL_SECTION criticalSection;
+#else
+    pthread_mutex_t mutex;
+#endif
+} SeerMutex;
+
+typedef struct SeerCondition {
+#if defined _WIN32
+    CONDITION_VARIABLE condition;
+#else
+    pthread_cond_t condition;
+#endif
+} SeerCondition;
+
+int seerThreadCreate(SeerThread* self, SeerThreadFn fn, void* arg);
+void seerThreadJoin(SeerThread* self);
+
+void seerMutexInit(SeerMutex* self);
+void seerMutexDestroy(SeerMutex* self);
+void seerMutexLock(SeerMutex* self);
+void seerMutexUnlock(SeerMutex* self);
+
+void seerConditionInit(SeerCondition* self);
+void seerConditionDestroy(SeerCondition* self);
+void seerConditionWait(SeerCondition* self, SeerMutex* mutex);
+void seerConditionSignal(SeerCondition* self);
+void seerConditionBroadcast(SeerCondition* self);
+
+#endif
@@ -0,0 +1,54 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_TRACE_H
+#define SEER_TRACE_H
+
+#include <monotonic-time/monotonic_time.h>
+#include <nimble-steps/steps.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ImprintAllocator;
+
+typedef enum SeerTraceEventType {
+    SeerTraceEventTypeUpdate,
+    SeerTraceEventTypeAuthoritativeArrived,
+    SeerTraceEventTypeCopyFromAuthoritative,
+    SeerTraceEventTypePredictionTick,
+    SeerTraceEventTypePredictionTicks,
+    SeerTraceEventTypePostPredictionTicks,
+    SeerTraceEventTypePredictedStateHash,
+    SeerTraceEventTypeAuthoritativeStateHash,
+    SeerTraceEventTypeSaveSnapshot,
+    SeerTraceEventTypeLoadSnapshot,
+} SeerTraceEventType;
+
+typedef enum SeerTraceEventPhase {
+    SeerTraceEventPhaseBegin,
+    SeerTraceEventPhaseEnd,
+    SeerTraceEventPhaseInstant,
+} SeerTraceEventPhase;
+
+typedef struct SeerTraceEvent {
+    MonotonicTimeNanoseconds time;
+    StepId stepId;
+    uint8_t type;
+    uint8_t phase;
+} SeerTraceEvent;
+
+/// Fixed size ring of binary trace events. When it is full, the oldest events are overwritten.
+/// Seer only records events if it is compiled with SEER_TRACE defined.
+typedef struct SeerTrace {
+    SeerTraceEvent* events;
+    size_t capacity;
+    size_t writeCount;
+} SeerTrace;
+
+void seerTraceInit(SeerTrace* self, struct ImprintAllocator* allocator, size_t capacity);
+void seerTraceClear(SeerTrace* self);
+void seerTraceAdd(SeerTrace* self, SeerTraceEventType type, SeerTraceEventPhase phase, StepId stepId);
+int seerTraceDumpToFile(const SeerTrace* self, const char* filename);
+
+#endif
@@ -0,0 +1,55 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_WORKER_H
+#define SEER_WORKER_H
+
+#include <seer/seer.h>
+#include <seer/thread.h>
+#include <stdbool.h>
+
+struct ImprintAllocator;
+struct ImprintAllocatorWithFree;
+
+typedef struct SeerWorkerPresentationBuffer {
+    uint8_t* octets;
+    size_t octetCount;
+    StepId stepId;
+} SeerWorkerPresentationBuffer;
+
+/// Runs seerUpdate() for a Seer on a dedicated thread.
+/// Predicted steps and authoritative states are handed over through the lock-free Seer enqueue functions.
+/// All Seer callbacks are called on the worker thread. The presentation state is fetched with saveSnapshotFn
+/// after each update and handed to the main thread through a triple buffer.
+typedef struct SeerWorker {
+    Seer* seer;
+    SeerThread thread;
+    SeerMutex mutex;
+    SeerCondition wakeUp;
+    bool updateRequested;
+    bool stopRequested;
+    bool isRunning;
+
+    struct ImprintAllocatorWithFree* allocatorWithFree;
+    SeerWorkerPresentationBuffer presentationBuffers[3];
+    size_t maxPresentationOctetCount;
+    size_t writeIndex;
+    size_t readyIndex;
+    size_t readIndex;
+    bool hasNewPresentation;
+    bool hasPresentation;
+    Clog log;
+} SeerWorker;
+
+void seerWorkerInit(SeerWorker* self, Seer* seer, struct ImprintAllocator* allocator,
+                    struct ImprintAllocatorWithFree* allocatorWithFree, size_t maxPresentationOctetCount, Clog log);
+void seerWorkerDestroy(SeerWorker* self);
+int seerWorkerStart(SeerWorker* self);
+void seerWorkerStop(SeerWorker* self);
+void seerWorkerRequestUpdate(SeerWorker* self);
+int seerWorkerAddPredictedStepRaw(SeerWorker* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId);
+int seerWorkerAuthoritativeGotNewState(SeerWorker* self, StepId stepId);
+const uint8_t* seerWorkerReadPredictedState(SeerWorker* self, size_t* octetCount, StepId* stepId);
+
+#endif
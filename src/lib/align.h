@@ -0,0 +1,26 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_ALIGN_H
+#define SEER_ALIGN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// alignment must be a power of two, zero is treated as one
+static inline size_t seerAlignOctetCount(size_t octetCount, size_t alignment)
+{
+    if (alignment <= 1) {
+        return octetCount;
+    }
+
+    return (octetCount + alignment - 1) & ~(alignment - 1);
+}
+
+static inline uint8_t* seerAlignPointer(uint8_t* octets, size_t alignment)
+{
+    return octets + (seerAlignOctetCount((size_t) (uintptr_t) octets, alignment) - (size_t) (uintptr_t) octets);
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SEER_ATOMIC_H
+#define SEER_ATOMIC_H
+
+#include <stddef.h>
+
+#if defined _MSC_VER
+#include <intrin.h>
+#include <windows.h>
+
+static inline size_t seerAtomicLoadAcquire(const size_t* value)
+{
+    size_t result = *(const volatile size_t*) value;
+    MemoryBarrier();
+    return result;
+}
+
+static inline void seerAtomicStoreRelease(size_t* value, size_t newValue)
+{
+    MemoryBarrier();
+    *(volatile size_t*) value = newValue;
+}
+
+#else
+
+static inline size_t seerAtomicLoadAcquire(const size_t* value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void seerAtomicStoreRelease(size_t* value, size_t newValue)
+{
+    __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,362 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <seer/capture.h>
+#include <seer/seer.h>
+#include <stdio.h>
+#include <tiny-libc/tiny_libc.h>
+
+// File header is the magic followed by a version octet. Each record is:
+// type (1), stepId (4), time in nanoseconds since the first record (8), payload octet count (4), payload
+// The payload of a predicted input record is the participant count (1) followed by, for each participant:
+// participantId (1), localPartyId (1), inputType (1), payload octet count (4), payload
+// The payload of an update record is one octet that is set if the update ran out of its time budget at stepId
+#define SEER_CAPTURE_MAGIC "SEERCAP"
+#define SEER_CAPTURE_MAGIC_OCTET_COUNT (7)
+#define SEER_CAPTURE_VERSION (2)
+#define SEER_CAPTURE_HEADER_OCTET_COUNT (SEER_CAPTURE_MAGIC_OCTET_COUNT + 1)
+#define SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT (1 + 4 + 8 + 4)
+#define SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT (1 + 1 + 1 + 4)
+
+static void seerCaptureWriteUint32(uint8_t* target, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        target[i] = (uint8_t) (value >> (i * 8));
+    }
+}
+
+static void seerCaptureWriteUint64(uint8_t* target, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        target[i] = (uint8_t) (value >> (i * 8));
+    }
+}
+
+static uint32_t seerCaptureReadUint32(const uint8_t* source)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t) source[i] << (i * 8);
+    }
+    return value;
+}
+
+static uint64_t seerCaptureReadUint64(const uint8_t* source)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= (uint64_t) source[i] << (i * 8);
+    }
+    return value;
+}
+
+/// The buffer must stay valid while recording. Records that do not fit are dropped and counted in
+/// droppedRecordCount.
+void seerRecorderInit(SeerRecorder* self, uint8_t* octets, size_t maxOctetCount,
+                      SeerRecorderSaveAuthoritativeFn saveAuthoritativeFn, void* saveAuthoritativeSelf)
+{
+    self->octets = octets;
+    self->maxOctetCount = maxOctetCount;
+    self->octetCount = 0;
+    self->hasStartTime = false;
+    self->startTime = 0;
+    self->droppedRecordCount = 0;
+    self->saveAuthoritativeFn = saveAuthoritativeFn;
+    self->saveAuthoritativeSelf = saveAuthoritativeSelf;
+
+    if (maxOctetCount < SEER_CAPTURE_HEADER_OCTET_COUNT) {
+        self->maxOctetCount = 0;
+        return;
+    }
+
+    tc_memcpy_octets(octets, SEER_CAPTURE_MAGIC, SEER_CAPTURE_MAGIC_OCTET_COUNT);
+    octets[SEER_CAPTURE_MAGIC_OCTET_COUNT] = SEER_CAPTURE_VERSION;
+    self->octetCount = SEER_CAPTURE_HEADER_OCTET_COUNT;
+}
+
+/// Writes the record header and reserves room for the payload.
+/// @return the payload target, or NULL if the record was dropped
+static uint8_t* seerRecorderBeginRecord(SeerRecorder* self, SeerCaptureRecordType type, StepId stepId,
+                                        size_t maxPayloadOctetCount)
+{
+    if (self->maxOctetCount - self->octetCount < SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT + maxPayloadOctetCount) {
+        self->droppedRecordCount++;
+        return 0;
+    }
+
+    MonotonicTimeNanoseconds now = monotonicTimeNanosecondsNow();
+    if (!self->hasStartTime) {
+        self->startTime = now;
+        self->hasStartTime = true;
+    }
+
+    uint8_t* target = &self->octets[self->octetCount];
+    target[0] = (uint8_t) type;
+    seerCaptureWriteUint32(&target[1], stepId);
+    seerCaptureWriteUint64(&target[5], (uint64_t) (now - self->startTime));
+    seerCaptureWriteUint32(&target[13], 0);
+
+    return target + SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT;
+}
+
+static void seerRecorderEndRecord(SeerRecorder* self, size_t payloadOctetCount)
+{
+    seerCaptureWriteUint32(&self->octets[self->octetCount + 13], (uint32_t) payloadOctetCount);
+    self->octetCount += SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT + payloadOctetCount;
+}
+
+/// Records a serialized combined step, either predicted or confirmed.
+void seerRecorderAddStep(SeerRecorder* self, SeerCaptureRecordType type, const uint8_t* combinedStep,
+                         size_t octetCount, StepId stepId)
+{
+    uint8_t* target = seerRecorderBeginRecord(self, type, stepId, octetCount);
+    if (target == 0) {
+        return;
+    }
+
+    tc_memcpy_octets(target, combinedStep, octetCount);
+    seerRecorderEndRecord(self, octetCount);
+}
+
+/// Records a predicted step that was added as an already decoded input, see seerAddPredictedStep()
+void seerRecorderAddInput(SeerRecorder* self, const TransmuteInput* input, StepId stepId)
+{
+    size_t payloadOctetCount = 1;
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        payloadOctetCount += SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT + input->participantInputs[i].octetSize;
+    }
+
+    uint8_t* target = seerRecorderBeginRecord(self, SeerCaptureRecordTypePredictedInput, stepId, payloadOctetCount);
+    if (target == 0) {
+        return;
+    }
+
+    *target++ = (uint8_t) input->participantCount;
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        const TransmuteParticipantInput* participant = &input->participantInputs[i];
+        target[0] = participant->participantId;
+        target[1] = participant->localPartyId;
+        target[2] = (uint8_t) participant->inputType;
+        seerCaptureWriteUint32(&target[3], (uint32_t) participant->octetSize);
+        target += SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT;
+        if (participant->octetSize > 0) {
+            tc_memcpy_octets(target, participant->input, participant->octetSize);
+            target += participant->octetSize;
+        }
+    }
+
+    seerRecorderEndRecord(self, payloadOctetCount);
+}
+
+/// Records a predicted step that was added from payload fragments, see seerAddPredictedStepGather(). It is recorded
+/// the same way as seerRecorderAddInput(), with the fragments joined.
+void seerRecorderAddGather(SeerRecorder* self, const SeerGatherParticipant* participants, size_t participantCount,
+                           StepId stepId)
+{
+    size_t payloadOctetCount = 1;
+    for (size_t i = 0; i < participantCount; ++i) {
+        payloadOctetCount += SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT;
+        for (size_t j = 0; j < participants[i].fragmentCount; ++j) {
+            payloadOctetCount += participants[i].fragments[j].octetCount;
+        }
+    }
+
+    uint8_t* target = seerRecorderBeginRecord(self, SeerCaptureRecordTypePredictedInput, stepId, payloadOctetCount);
+    if (target == 0) {
+        return;
+    }
+
+    *target++ = (uint8_t) participantCount;
+    for (size_t i = 0; i < participantCount; ++i) {
+        const SeerGatherParticipant* participant = &participants[i];
+        uint8_t* participantTarget = target;
+        target += SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT;
+        size_t octetSize = 0;
+        for (size_t j = 0; j < participant->fragmentCount; ++j) {
+            const SeerPayloadFragment* fragment = &participant->fragments[j];
+            if (fragment->octetCount > 0) {
+                tc_memcpy_octets(target, fragment->octets, fragment->octetCount);
+                target += fragment->octetCount;
+                octetSize += fragment->octetCount;
+            }
+        }
+        participantTarget[0] = participant->participantId;
+        participantTarget[1] = participant->localPartyId;
+        participantTarget[2] = (uint8_t) participant->inputType;
+        seerCaptureWriteUint32(&participantTarget[3], (uint32_t) octetSize);
+    }
+
+    seerRecorderEndRecord(self, payloadOctetCount);
+}
+
+/// Records the authoritative step, and the authoritative state if saveAuthoritativeFn was provided.
+void seerRecorderAuthoritativeGotNewState(SeerRecorder* self, StepId stepId)
+{
+    uint8_t* target = seerRecorderBeginRecord(self, SeerCaptureRecordTypeAuthoritativeState, stepId, 0);
+    if (target == 0) {
+        return;
+    }
+
+    size_t payloadOctetCount = 0;
+    if (self->saveAuthoritativeFn != 0) {
+        size_t maxPayloadOctetCount = self->maxOctetCount - self->octetCount - SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT;
+        int octetCount = self->saveAuthoritativeFn(self->saveAuthoritativeSelf, target, maxPayloadOctetCount, stepId);
+        if (octetCount < 0) {
+            self->droppedRecordCount++;
+            return;
+        }
+        payloadOctetCount = (size_t) octetCount;
+    }
+
+    seerRecorderEndRecord(self, payloadOctetCount);
+}
+
+/// Records an update after it has predicted. stepId is the step the prediction reached. If the update ran out of its
+/// time budget, it is played back with seerUpdateUntilStepId(), so it stops at the same step.
+void seerRecorderUpdate(SeerRecorder* self, StepId stepId, bool isOutOfBudget)
+{
+    uint8_t* target = seerRecorderBeginRecord(self, SeerCaptureRecordTypeUpdate, stepId, 1);
+    if (target == 0) {
+        return;
+    }
+
+    target[0] = isOutOfBudget ? 1 : 0;
+    seerRecorderEndRecord(self, 1);
+}
+
+/// @return octet count written, or negative on error
+int seerRecorderWriteToFile(const SeerRecorder* self, const char* filename)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (fp == 0) {
+        return -1;
+    }
+
+    size_t writtenOctetCount = fwrite(self->octets, 1, self->octetCount, fp);
+    if (fclose(fp) != 0 || writtenOctetCount != self->octetCount) {
+        return -2;
+    }
+
+    return (int) writtenOctetCount;
+}
+
+/// The capture octets (for example a memory mapped file) must stay valid while playing.
+/// @return negative if the octets are not a capture
+int seerPlayerInit(SeerPlayer* self, const uint8_t* octets, size_t octetCount,
+                   SeerPlayerLoadAuthoritativeFn loadAuthoritativeFn, void* loadAuthoritativeSelf)
+{
+    if (octetCount < SEER_CAPTURE_HEADER_OCTET_COUNT ||
+        tc_memcmp(octets, SEER_CAPTURE_MAGIC, SEER_CAPTURE_MAGIC_OCTET_COUNT) != 0) {
+        return -1;
+    }
+
+    if (octets[SEER_CAPTURE_MAGIC_OCTET_COUNT] != SEER_CAPTURE_VERSION) {
+        return -2;
+    }
+
+    self->octets = octets;
+    self->octetCount = octetCount;
+    self->position = SEER_CAPTURE_HEADER_OCTET_COUNT;
+    self->time = 0;
+    self->loadAuthoritativeFn = loadAuthoritativeFn;
+    self->loadAuthoritativeSelf = loadAuthoritativeSelf;
+
+    return 0;
+}
+
+/// Decodes a predicted input record into the participant inputs of the player. The inputs point into payload.
+/// @return negative if the record is malformed
+static int seerPlayerReadInput(SeerPlayer* self, TransmuteInput* target, const uint8_t* payload,
+                               size_t payloadOctetCount)
+{
+    if (payloadOctetCount < 1) {
+        return -1;
+    }
+
+    size_t participantCount = payload[0];
+    if (participantCount > SEER_PLAYER_MAX_PARTICIPANT_COUNT) {
+        return -2;
+    }
+
+    size_t position = 1;
+    for (size_t i = 0; i < participantCount; ++i) {
+        if (payloadOctetCount - position < SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT) {
+            return -1;
+        }
+        const uint8_t* source = &payload[position];
+        size_t octetSize = seerCaptureReadUint32(&source[3]);
+        position += SEER_CAPTURE_PARTICIPANT_HEADER_OCTET_COUNT;
+        if (payloadOctetCount - position < octetSize) {
+            return -1;
+        }
+
+        TransmuteParticipantInput* participant = &self->participantInputs[i];
+        participant->participantId = source[0];
+        participant->localPartyId = source[1];
+        participant->inputType = (TransmuteParticipantInputType) source[2];
+        participant->octetSize = octetSize;
+        participant->input = octetSize > 0 ? &payload[position] : 0;
+        position += octetSize;
+    }
+
+    target->participantInputs = self->participantInputs;
+    target->participantCount = participantCount;
+
+    return 0;
+}
+
+/// Plays the records up to and including the next update. time is set to the recorded time of the update, so the
+/// caller can reproduce the original timing.
+/// @return 1 if an update was played, 0 at the end of the capture, negative on error
+int seerPlayerUpdate(SeerPlayer* self, Seer* seer)
+{
+    while (self->octetCount - self->position >= SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT) {
+        const uint8_t* record = &self->octets[self->position];
+        uint8_t type = record[0];
+        StepId stepId = seerCaptureReadUint32(&record[1]);
+        MonotonicTimeNanoseconds time = (MonotonicTimeNanoseconds) seerCaptureReadUint64(&record[5]);
+        size_t payloadOctetCount = seerCaptureReadUint32(&record[13]);
+        const uint8_t* payload = record + SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT;
+
+        if (self->octetCount - self->position - SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT < payloadOctetCount) {
+            return -2;
+        }
+        self->position += SEER_CAPTURE_RECORD_HEADER_OCTET_COUNT + payloadOctetCount;
+        self->time = time;
+
+        switch ((SeerCaptureRecordType) type) {
+            case SeerCaptureRecordTypePredictedStep:
+                seerAddPredictedStepRaw(seer, payload, payloadOctetCount, stepId);
+                continue;
+            case SeerCaptureRecordTypeConfirmedStep:
+                seerConfirmStepRaw(seer, payload, payloadOctetCount, stepId);
+                continue;
+            case SeerCaptureRecordTypeAuthoritativeState:
+                if (self->loadAuthoritativeFn != 0) {
+                    self->loadAuthoritativeFn(self->loadAuthoritativeSelf, payload, payloadOctetCount, stepId);
+                }
+                seerAuthoritativeGotNewState(seer, stepId);
+                continue;
+            case SeerCaptureRecordTypeUpdate:
+                if (payloadOctetCount >= 1 && payload[0] != 0) {
+                    seerUpdateUntilStepId(seer, stepId);
+                } else {
+                    seerUpdate(seer);
+                }
+                return 1;
+            case SeerCaptureRecordTypePredictedInput: {
+                TransmuteInput input;
+                if (seerPlayerReadInput(self, &input, payload, payloadOctetCount) < 0) {
+                    return -4;
+                }
+                seerAddPredictedStep(seer, &input, stepId);
+                continue;
+            }
+        }
+
+        return -3;
+    }
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <imprint/allocator.h>
+#include <seer/checkpoints.h>
+
+/// Checkpoints are disabled if interval or maxOctetSize is zero.
+/// maxTicks is the number of ticks that can be predicted from the authoritative state.
+void seerCheckpointsInit(SeerCheckpoints* self, struct ImprintAllocator* allocator, size_t maxTicks, size_t interval,
+                         size_t maxOctetSize)
+{
+    self->interval = interval;
+    self->maxOctetSize = maxOctetSize;
+    if (interval == 0 || maxOctetSize == 0) {
+        self->capacity = 0;
+        self->checkpoints = 0;
+        self->octets = 0;
+        return;
+    }
+
+    self->capacity = maxTicks / interval + 1;
+    self->checkpoints = IMPRINT_ALLOC_TYPE_COUNT(allocator, SeerCheckpoint, self->capacity);
+    self->octets = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t, self->capacity * maxOctetSize);
+
+    for (size_t i = 0; i < self->capacity; ++i) {
+        self->checkpoints[i].octets = &self->octets[i * maxOctetSize];
+        self->checkpoints[i].octetCount = 0;
+        self->checkpoints[i].isValid = false;
+    }
+}
+
+void seerCheckpointsDestroy(SeerCheckpoints* self, struct ImprintAllocatorWithFree* allocatorWithFree)
+{
+    if (self->capacity == 0) {
+        return;
+    }
+
+    IMPRINT_FREE(allocatorWithFree, self->checkpoints);
+    IMPRINT_FREE(allocatorWithFree, self->octets);
+    self->checkpoints = 0;
+    self->octets = 0;
+    self->capacity = 0;
+}
+
+bool seerCheckpointsIsEnabled(const SeerCheckpoints* self)
+{
+    return self->capacity > 0;
+}
+
+bool seerCheckpointsShouldSave(const SeerCheckpoints* self, StepId stepId)
+{
+    if (self->capacity == 0 || (stepId % self->interval) != 0) {
+        return false;
+    }
+
+    const SeerCheckpoint* checkpoint = &self->checkpoints[(stepId / self->interval) % self->capacity];
+
+    return !(checkpoint->isValid && checkpoint->stepId == stepId);
+}
+
+SeerCheckpoint* seerCheckpointsSlot(SeerCheckpoints* self, StepId stepId)
+{
+    return &self->checkpoints[(stepId / self->interval) % self->capacity];
+}
+
+/// Finds the latest valid checkpoint that is at or before stepId, but not before lowestStepId.
+/// @return the checkpoint or NULL if none was found
+const SeerCheckpoint* seerCheckpointsFindNearest(const SeerCheckpoints* self, StepId stepId, StepId lowestStepId)
+{
+    const SeerCheckpoint* nearest = 0;
+
+    for (size_t i = 0; i < self->capacity; ++i) {
+        const SeerCheckpoint* checkpoint = &self->checkpoints[i];
+        if (!checkpoint->isValid || checkpoint->stepId > stepId || checkpoint->stepId < lowestStepId) {
+            continue;
+        }
+        if (nearest == 0 || checkpoint->stepId > nearest->stepId) {
+            nearest = checkpoint;
+        }
+    }
+
+    return nearest;
+}
+
+/// Invalidates all checkpoints that were taken after stepId
+void seerCheckpointsInvalidateAfter(SeerCheckpoints* self, StepId stepId)
+{
+    for (size_t i = 0; i < self->capacity; ++i) {
+        if (self->checkpoints[i].stepId > stepId) {
+            self->checkpoints[i].isValid = false;
+        }
+    }
+}
+
+void seerCheckpointsInvalidateAll(SeerCheckpoints* self)
+{
+    for (size_t i = 0; i < self->capacity; ++i) {
+        self->checkpoints[i].isValid = false;
+    }
+}
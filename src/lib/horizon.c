@@ -0,0 +1,92 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <seer/horizon.h>
+
+// Each new sample moves the average 1/8 of the way
+#define SEER_ADAPTIVE_HORIZON_SMOOTHING_SHIFT (3)
+
+/// Starts disabled, with a fixed horizon of maxTicks.
+void seerAdaptiveHorizonInit(SeerAdaptiveHorizon* self, size_t maxTicks)
+{
+    self->setup.minTicks = maxTicks;
+    self->setup.maxTicks = maxTicks;
+    self->setup.marginTicks = 0;
+    self->setup.maxPredictionTimePerUpdate = 0;
+    self->isEnabled = false;
+    self->latencyTicksAverage = 0;
+    self->hasLatency = false;
+    self->tickCostAverage = 0;
+    self->hasTickCost = false;
+    self->horizonTicks = maxTicks;
+}
+
+static void seerAdaptiveHorizonRecalculate(SeerAdaptiveHorizon* self)
+{
+    if (!self->isEnabled) {
+        return;
+    }
+
+    size_t horizonTicks = self->setup.maxTicks;
+
+    if (self->hasLatency) {
+        int64_t roundedUp = (self->latencyTicksAverage + (1 << SEER_ADAPTIVE_HORIZON_FRACTION_BITS) - 1) >>
+                            SEER_ADAPTIVE_HORIZON_FRACTION_BITS;
+        horizonTicks = (size_t) roundedUp + self->setup.marginTicks;
+    }
+
+    if (self->hasTickCost && self->tickCostAverage > 0 && self->setup.maxPredictionTimePerUpdate > 0) {
+        size_t affordableTicks = (size_t) (self->setup.maxPredictionTimePerUpdate / self->tickCostAverage);
+        if (affordableTicks < horizonTicks) {
+            horizonTicks = affordableTicks;
+        }
+    }
+
+    if (horizonTicks < self->setup.minTicks) {
+        horizonTicks = self->setup.minTicks;
+    }
+    if (horizonTicks > self->setup.maxTicks) {
+        horizonTicks = self->setup.maxTicks;
+    }
+
+    self->horizonTicks = horizonTicks;
+}
+
+void seerAdaptiveHorizonSet(SeerAdaptiveHorizon* self, SeerAdaptiveHorizonSetup setup)
+{
+    if (setup.minTicks > setup.maxTicks) {
+        setup.minTicks = setup.maxTicks;
+    }
+    self->setup = setup;
+    self->isEnabled = true;
+    self->horizonTicks = setup.maxTicks;
+    seerAdaptiveHorizonRecalculate(self);
+}
+
+/// latencyTicks is how many ticks the newest predicted step was ahead of the authoritative state that arrived.
+void seerAdaptiveHorizonAddLatency(SeerAdaptiveHorizon* self, size_t latencyTicks)
+{
+    int64_t sample = (int64_t) latencyTicks << SEER_ADAPTIVE_HORIZON_FRACTION_BITS;
+    if (!self->hasLatency) {
+        self->latencyTicksAverage = sample;
+        self->hasLatency = true;
+    } else {
+        self->latencyTicksAverage += (sample - self->latencyTicksAverage) /
+                                     (1 << SEER_ADAPTIVE_HORIZON_SMOOTHING_SHIFT);
+    }
+
+    seerAdaptiveHorizonRecalculate(self);
+}
+
+void seerAdaptiveHorizonAddTickCost(SeerAdaptiveHorizon* self, MonotonicTimeNanoseconds tickCost)
+{
+    if (!self->hasTickCost) {
+        self->tickCostAverage = tickCost;
+        self->hasTickCost = true;
+    } else {
+        self->tickCostAverage += (tickCost - self->tickCostAverage) / (1 << SEER_ADAPTIVE_HORIZON_SMOOTHING_SHIFT);
+    }
+
+    seerAdaptiveHorizonRecalculate(self);
+}
@@ -0,0 +1,204 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "align.h"
+#include <imprint/allocator.h>
+#include <seer/input_predictor.h>
+#include <tiny-libc/tiny_libc.h>
+
+void seerInputPredictorInit(SeerInputPredictor* self, struct ImprintAllocator* allocator, size_t maxParticipantCount,
+                            size_t maxOctetSizeForSingleParticipant, size_t payloadAlignment)
+{
+    self->setup.mode = SeerInputPredictorModeNone;
+    self->setup.ticksUntilNeutral = 0;
+    self->setup.predictParticipantInputFn = 0;
+    self->setup.predictParticipantInputSelf = 0;
+    self->maxParticipantCount = maxParticipantCount;
+    self->maxOctetSizeForSingleParticipant = maxOctetSizeForSingleParticipant;
+
+    if (payloadAlignment < 1) {
+        payloadAlignment = 1;
+    }
+    self->payloadStride = seerAlignOctetCount(maxOctetSizeForSingleParticipant, payloadAlignment);
+    size_t payloadOctetCount = maxParticipantCount * self->payloadStride;
+    self->payloadsAllocation = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t,
+                                                        payloadOctetCount * 2 + payloadAlignment - 1);
+    self->lastConfirmedPayloads = seerAlignPointer(self->payloadsAllocation, payloadAlignment);
+    self->predictedPayloads = self->lastConfirmedPayloads + payloadOctetCount;
+
+    self->lastConfirmed.participantInputs = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteParticipantInput,
+                                                                     maxParticipantCount);
+    self->lastConfirmed.participantCount = 0;
+    self->predicted.participantInputs = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteParticipantInput,
+                                                                 maxParticipantCount);
+    self->predicted.participantCount = 0;
+
+    seerInputPredictorReset(self);
+}
+
+void seerInputPredictorDestroy(SeerInputPredictor* self, struct ImprintAllocatorWithFree* allocatorWithFree)
+{
+    IMPRINT_FREE(allocatorWithFree, self->lastConfirmed.participantInputs);
+    IMPRINT_FREE(allocatorWithFree, self->payloadsAllocation);
+    IMPRINT_FREE(allocatorWithFree, self->predicted.participantInputs);
+    self->lastConfirmed.participantInputs = 0;
+    self->payloadsAllocation = 0;
+    self->lastConfirmedPayloads = 0;
+    self->predicted.participantInputs = 0;
+    self->predictedPayloads = 0;
+    self->maxParticipantCount = 0;
+}
+
+/// Forgets the confirmed inputs, but keeps the setup.
+void seerInputPredictorReset(SeerInputPredictor* self)
+{
+    self->lastConfirmed.participantCount = 0;
+    self->predicted.participantCount = 0;
+    self->lastConfirmedStepId = 0;
+    self->hasLastConfirmed = false;
+}
+
+void seerInputPredictorSet(SeerInputPredictor* self, SeerInputPredictorSetup setup)
+{
+    self->setup = setup;
+}
+
+bool seerInputPredictorIsEnabled(const SeerInputPredictor* self)
+{
+    return self->setup.mode != SeerInputPredictorModeNone;
+}
+
+/// Remembers the confirmed input for each participant. Participants that are not in the input keep their
+/// previously confirmed input.
+void seerInputPredictorConfirmed(SeerInputPredictor* self, const TransmuteInput* input, StepId tickId)
+{
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        const TransmuteParticipantInput* source = &input->participantInputs[i];
+        if (source->octetSize > self->maxOctetSizeForSingleParticipant) {
+            continue;
+        }
+
+        size_t targetIndex = 0;
+        while (targetIndex < self->lastConfirmed.participantCount &&
+               self->lastConfirmed.participantInputs[targetIndex].participantId != source->participantId) {
+            targetIndex++;
+        }
+
+        if (targetIndex == self->lastConfirmed.participantCount) {
+            if (targetIndex >= self->maxParticipantCount) {
+                continue;
+            }
+            self->lastConfirmed.participantCount++;
+        }
+
+        uint8_t* payload = &self->lastConfirmedPayloads[targetIndex * self->payloadStride];
+        TransmuteParticipantInput* target = &self->lastConfirmed.participantInputs[targetIndex];
+        *target = *source;
+        if (source->octetSize > 0) {
+            tc_memcpy_octets(payload, source->input, source->octetSize);
+            target->input = payload;
+        } else {
+            target->input = 0;
+        }
+    }
+
+    self->lastConfirmedStepId = tickId;
+    self->hasLastConfirmed = true;
+}
+
+static bool seerInputPredictorContains(const TransmuteInput* input, uint8_t participantId)
+{
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        if (input->participantInputs[i].participantId == participantId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool seerInputPredictorSynthesize(SeerInputPredictor* self, const TransmuteParticipantInput* lastConfirmed,
+                                         size_t ticksSinceConfirmed, StepId tickId,
+                                         TransmuteParticipantInput* target, uint8_t* payloadTarget)
+{
+    *target = *lastConfirmed;
+
+    // A participant only joins once, in the ticks after that it is predicted to send normal inputs
+    if (lastConfirmed->inputType == TransmuteParticipantInputTypeJoined) {
+        target->inputType = TransmuteParticipantInputTypeNormal;
+    } else if (lastConfirmed->inputType != TransmuteParticipantInputTypeNormal) {
+        return lastConfirmed->inputType != TransmuteParticipantInputTypeLeft;
+    }
+
+    switch (self->setup.mode) {
+        case SeerInputPredictorModeNone:
+            return false;
+        case SeerInputPredictorModeRepeatLast:
+            return true;
+        case SeerInputPredictorModeDecayToNeutral:
+            if (ticksSinceConfirmed > self->setup.ticksUntilNeutral) {
+                tc_memset_octets(payloadTarget, 0, lastConfirmed->octetSize);
+                target->input = payloadTarget;
+            }
+            return true;
+        case SeerInputPredictorModeCustom: {
+            int octetCount = self->setup.predictParticipantInputFn(self->setup.predictParticipantInputSelf,
+                                                                   lastConfirmed, ticksSinceConfirmed, payloadTarget,
+                                                                   self->maxOctetSizeForSingleParticipant, tickId);
+            if (octetCount < 0) {
+                return false;
+            }
+            target->input = octetCount > 0 ? payloadTarget : 0;
+            target->octetSize = (size_t) octetCount;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// Completes the predicted step with synthesized inputs for the participants that are missing in it.
+/// predictedStep can be NULL if there is no predicted step for the tick.
+/// The returned input is valid until the next call.
+/// @return the completed input, predictedStep if nothing was synthesized, or NULL if there is nothing to predict from
+const TransmuteInput* seerInputPredictorPredict(SeerInputPredictor* self, const TransmuteInput* predictedStep,
+                                                StepId tickId, size_t* synthesizedCount)
+{
+    *synthesizedCount = 0;
+
+    if (!seerInputPredictorIsEnabled(self) || !self->hasLastConfirmed || tickId <= self->lastConfirmedStepId) {
+        return predictedStep;
+    }
+
+    size_t participantCount = 0;
+    if (predictedStep != 0) {
+        for (size_t i = 0; i < predictedStep->participantCount && i < self->maxParticipantCount; ++i) {
+            self->predicted.participantInputs[participantCount++] = predictedStep->participantInputs[i];
+        }
+    }
+
+    size_t ticksSinceConfirmed = (size_t) (tickId - self->lastConfirmedStepId);
+    for (size_t i = 0; i < self->lastConfirmed.participantCount && participantCount < self->maxParticipantCount;
+         ++i) {
+        const TransmuteParticipantInput* lastConfirmed = &self->lastConfirmed.participantInputs[i];
+        if (predictedStep != 0 && seerInputPredictorContains(predictedStep, lastConfirmed->participantId)) {
+            continue;
+        }
+
+        uint8_t* payloadTarget = &self->predictedPayloads[i * self->payloadStride];
+        if (seerInputPredictorSynthesize(self, lastConfirmed, ticksSinceConfirmed, tickId,
+                                         &self->predicted.participantInputs[participantCount], payloadTarget)) {
+            participantCount++;
+            (*synthesizedCount)++;
+        }
+    }
+
+    if (*synthesizedCount == 0) {
+        return predictedStep;
+    }
+
+    self->predicted.participantCount = participantCount;
+
+    return &self->predicted;
+}
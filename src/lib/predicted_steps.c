@@ -0,0 +1,591 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "align.h"
+#include <imprint/allocator.h>
+#include <seer/predicted_steps.h>
+#include <tiny-libc/tiny_libc.h>
+
+static size_t seerPredictedStepsRoundUpToPowerOfTwo(size_t count)
+{
+    size_t powerOfTwo = 1;
+    while (powerOfTwo < count) {
+        powerOfTwo <<= 1;
+    }
+
+    return powerOfTwo;
+}
+
+/// capacity is rounded up to the nearest power of two. payloadAlignment must be a power of two, or zero for no
+/// alignment. Serialized combined steps up to maxRawOctetCount are kept, so a step that is sent again can be
+/// recognized without decoding it, zero to not keep them. If useSoa is set, the struct of arrays view is filled in for
+/// every written step.
+void seerPredictedStepsInit(SeerPredictedSteps* self, struct ImprintAllocator* allocator, size_t capacity,
+                            size_t maxParticipantCount, size_t maxOctetSizeForSingleParticipant,
+                            size_t payloadAlignment, size_t maxRawOctetCount, bool useSoa, Clog log)
+{
+    capacity = seerPredictedStepsRoundUpToPowerOfTwo(capacity);
+    self->capacity = capacity;
+    self->indexMask = capacity - 1;
+    self->maxParticipantCount = maxParticipantCount;
+    self->payloadAlignment = payloadAlignment > 1 ? payloadAlignment : 1;
+    self->maxPayloadOctetCountPerStep = seerAlignOctetCount(maxOctetSizeForSingleParticipant, self->payloadAlignment) *
+                                        maxParticipantCount;
+    self->inputs = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteInput, capacity);
+    self->participantInputs = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteParticipantInput,
+                                                       capacity * maxParticipantCount);
+    self->stepIds = IMPRINT_ALLOC_TYPE_COUNT(allocator, StepId, capacity);
+    self->maxRawOctetCount = maxRawOctetCount;
+    self->rawOctets = maxRawOctetCount > 0 ? IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t, capacity * maxRawOctetCount)
+                                           : 0;
+    self->rawOctetCounts = IMPRINT_ALLOC_TYPE_COUNT(allocator, size_t, capacity);
+    self->payloadArenaAllocation = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t,
+                                                           capacity * self->maxPayloadOctetCountPerStep +
+                                                               self->payloadAlignment - 1);
+    self->payloadArena = seerAlignPointer(self->payloadArenaAllocation, self->payloadAlignment);
+    self->hasSoa = useSoa;
+    if (useSoa) {
+        size_t soaCount = capacity * maxParticipantCount;
+        self->soaParticipantIds = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t, soaCount);
+        self->soaInputTypes = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteParticipantInputType, soaCount);
+        self->soaPayloads = IMPRINT_ALLOC_TYPE_COUNT(allocator, const void*, soaCount);
+        self->soaOctetSizes = IMPRINT_ALLOC_TYPE_COUNT(allocator, size_t, soaCount);
+    } else {
+        self->soaParticipantIds = 0;
+        self->soaInputTypes = 0;
+        self->soaPayloads = 0;
+        self->soaOctetSizes = 0;
+    }
+    self->log = log;
+
+    for (size_t i = 0; i < capacity; ++i) {
+        self->inputs[i].participantInputs = &self->participantInputs[i * maxParticipantCount];
+        self->inputs[i].participantCount = 0;
+        self->rawOctetCounts[i] = 0;
+    }
+
+    seerPredictedStepsReInit(self, 0);
+}
+
+void seerPredictedStepsDestroy(SeerPredictedSteps* self, struct ImprintAllocatorWithFree* allocatorWithFree)
+{
+    IMPRINT_FREE(allocatorWithFree, self->inputs);
+    IMPRINT_FREE(allocatorWithFree, self->participantInputs);
+    IMPRINT_FREE(allocatorWithFree, self->stepIds);
+    if (self->rawOctets != 0) {
+        IMPRINT_FREE(allocatorWithFree, self->rawOctets);
+    }
+    IMPRINT_FREE(allocatorWithFree, self->rawOctetCounts);
+    IMPRINT_FREE(allocatorWithFree, self->payloadArenaAllocation);
+    if (self->hasSoa) {
+        IMPRINT_FREE(allocatorWithFree, self->soaParticipantIds);
+        IMPRINT_FREE(allocatorWithFree, self->soaInputTypes);
+        IMPRINT_FREE(allocatorWithFree, self->soaPayloads);
+        IMPRINT_FREE(allocatorWithFree, self->soaOctetSizes);
+    }
+    self->soaParticipantIds = 0;
+    self->soaInputTypes = 0;
+    self->soaPayloads = 0;
+    self->soaOctetSizes = 0;
+    self->hasSoa = false;
+    self->inputs = 0;
+    self->participantInputs = 0;
+    self->stepIds = 0;
+    self->rawOctets = 0;
+    self->maxRawOctetCount = 0;
+    self->rawOctetCounts = 0;
+    self->payloadArena = 0;
+    self->payloadArenaAllocation = 0;
+    self->capacity = 0;
+    self->stepsCount = 0;
+}
+
+void seerPredictedStepsReInit(SeerPredictedSteps* self, StepId stepId)
+{
+    self->tailStepId = stepId;
+    self->headStepId = stepId;
+    self->stepsCount = 0;
+}
+
+static uint8_t* seerPredictedStepsSlice(const SeerPredictedSteps* self, StepId stepId)
+{
+    return &self->payloadArena[(stepId & self->indexMask) * self->maxPayloadOctetCountPerStep];
+}
+
+/// Where the payload for the participant is stored in the slice for the step, when it is not shared
+static size_t seerPredictedStepsPayloadOffset(const SeerPredictedSteps* self, const TransmuteInput* input,
+                                              size_t participantIndex)
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < participantIndex; ++i) {
+        offset += seerAlignOctetCount(input->participantInputs[i].octetSize, self->payloadAlignment);
+    }
+
+    return offset;
+}
+
+/// Copies a shared payload for the participant into the slice of ownerStepId, and lets the steps from firstStepId to
+/// lastStepId use that copy.
+static void seerPredictedStepsMoveShared(SeerPredictedSteps* self, StepId ownerStepId, StepId firstStepId,
+                                         StepId lastStepId, size_t participantIndex, const void* shared,
+                                         size_t octetCount)
+{
+    const TransmuteInput* owner = &self->inputs[ownerStepId & self->indexMask];
+    uint8_t* target = seerPredictedStepsSlice(self, ownerStepId) +
+                      seerPredictedStepsPayloadOffset(self, owner, participantIndex);
+    if (target != shared) {
+        tc_memcpy_octets(target, shared, octetCount);
+    }
+
+    for (StepId id = firstStepId; id <= lastStepId; ++id) {
+        size_t index = id & self->indexMask;
+        self->inputs[index].participantInputs[participantIndex].input = target;
+        if (self->hasSoa) {
+            self->soaPayloads[index * self->maxParticipantCount + participantIndex] = target;
+        }
+    }
+}
+
+/// The steps after stepId that share its payload for the participant, get the payload copied into the slice of the
+/// last of them, since that is the one that is discarded last. Must be called before the slice for stepId is
+/// overwritten or discarded.
+static void seerPredictedStepsDetachShared(SeerPredictedSteps* self, StepId stepId, size_t participantIndex)
+{
+    const TransmuteParticipantInput* participant = &self->inputs[stepId & self->indexMask]
+                                                        .participantInputs[participantIndex];
+    const void* shared = participant->input;
+    if (shared == 0) {
+        return;
+    }
+
+    StepId lastStepId = stepId;
+    while ((StepId) (lastStepId + 1) < self->headStepId) {
+        const TransmuteInput* next = &self->inputs[(lastStepId + 1) & self->indexMask];
+        if (participantIndex >= next->participantCount || next->participantInputs[participantIndex].input != shared) {
+            break;
+        }
+        lastStepId++;
+    }
+
+    if (lastStepId == stepId) {
+        return;
+    }
+
+    seerPredictedStepsMoveShared(self, lastStepId, (StepId) (stepId + 1), lastStepId, participantIndex, shared,
+                                 participant->octetSize);
+}
+
+/// The steps before stepId that use a payload stored in the slice for stepId (moved there when the step that first
+/// stored it was discarded), get the payload copied into the slice of the first of them. Must be called before the
+/// slice for stepId is overwritten.
+static void seerPredictedStepsDetachSharedBefore(SeerPredictedSteps* self, StepId stepId, size_t participantIndex)
+{
+    const TransmuteParticipantInput* participant = &self->inputs[stepId & self->indexMask]
+                                                        .participantInputs[participantIndex];
+    const uint8_t* shared = (const uint8_t*) participant->input;
+    const uint8_t* slice = seerPredictedStepsSlice(self, stepId);
+    if (shared == 0 || shared < slice || shared >= slice + self->maxPayloadOctetCountPerStep) {
+        return;
+    }
+
+    StepId firstStepId = stepId;
+    while (firstStepId > self->tailStepId) {
+        const TransmuteInput* previous = &self->inputs[(StepId) (firstStepId - 1) & self->indexMask];
+        if (participantIndex >= previous->participantCount ||
+            previous->participantInputs[participantIndex].input != shared) {
+            break;
+        }
+        firstStepId--;
+    }
+
+    if (firstStepId == stepId) {
+        return;
+    }
+
+    seerPredictedStepsMoveShared(self, firstStepId, firstStepId, (StepId) (stepId - 1), participantIndex, shared,
+                                 participant->octetSize);
+}
+
+/// Finds the same participant in the step before, if it has a payload of the same size that could be shared.
+static const TransmuteParticipantInput* seerPredictedStepsPrevious(const SeerPredictedSteps* self, StepId stepId,
+                                                                   size_t participantIndex, uint8_t participantId,
+                                                                   size_t octetCount)
+{
+    if (octetCount == 0 || self->stepsCount == 0 || stepId <= self->tailStepId) {
+        return 0;
+    }
+
+    const TransmuteInput* previousInput = &self->inputs[(StepId) (stepId - 1) & self->indexMask];
+    if (participantIndex >= previousInput->participantCount) {
+        return 0;
+    }
+
+    const TransmuteParticipantInput* previous = &previousInput->participantInputs[participantIndex];
+    if (previous->participantId != participantId || previous->octetSize != octetCount) {
+        return 0;
+    }
+
+    return previous;
+}
+
+/// Checks that the step can be written and finds the slot for it.
+/// New steps must be written in order, but a step that is already in the buffer can be replaced.
+/// @return the slot index, or negative on error
+static int seerPredictedStepsPrepareWrite(SeerPredictedSteps* self, StepId stepId, size_t participantCount,
+                                          size_t totalPayloadOctetCount, bool* isReplacing)
+{
+    if (self->stepsCount == 0 && stepId > self->headStepId) {
+        self->tailStepId = stepId;
+        self->headStepId = stepId;
+    }
+
+    *isReplacing = self->stepsCount > 0 && stepId >= self->tailStepId && stepId < self->headStepId;
+
+    if (stepId != self->headStepId && !*isReplacing) {
+        CLOG_C_SOFT_ERROR(&self->log, "predicted steps must be consecutive, expected %08X but got %08X",
+                          self->headStepId, stepId)
+        return -2;
+    }
+
+    if (!*isReplacing && self->stepsCount >= self->capacity) {
+        CLOG_C_SOFT_ERROR(&self->log, "predicted steps buffer is full (%zu)", self->capacity)
+        return -3;
+    }
+
+    if (participantCount > self->maxParticipantCount) {
+        CLOG_C_SOFT_ERROR(&self->log, "Too many participants %zu", participantCount)
+        return -4;
+    }
+
+    if (totalPayloadOctetCount > self->maxPayloadOctetCountPerStep) {
+        CLOG_C_SOFT_ERROR(&self->log, "predicted step %08X is too large", stepId)
+        return -5;
+    }
+
+    if (*isReplacing) {
+        const TransmuteInput* replaced = &self->inputs[stepId & self->indexMask];
+        for (size_t i = 0; i < replaced->participantCount; ++i) {
+            seerPredictedStepsDetachShared(self, stepId, i);
+            seerPredictedStepsDetachSharedBefore(self, stepId, i);
+        }
+    }
+
+    return (int) (stepId & self->indexMask);
+}
+
+/// Fills in the struct of arrays view from the participant inputs, one pass for each field.
+static void seerPredictedStepsFillSoa(SeerPredictedSteps* self, size_t index, size_t participantCount)
+{
+    const TransmuteParticipantInput* source = self->inputs[index].participantInputs;
+    size_t offset = index * self->maxParticipantCount;
+
+    uint8_t* participantIds = &self->soaParticipantIds[offset];
+    for (size_t i = 0; i < participantCount; ++i) {
+        participantIds[i] = source[i].participantId;
+    }
+
+    TransmuteParticipantInputType* inputTypes = &self->soaInputTypes[offset];
+    for (size_t i = 0; i < participantCount; ++i) {
+        inputTypes[i] = source[i].inputType;
+    }
+
+    const void** payloads = &self->soaPayloads[offset];
+    for (size_t i = 0; i < participantCount; ++i) {
+        payloads[i] = source[i].input;
+    }
+
+    size_t* octetSizes = &self->soaOctetSizes[offset];
+    for (size_t i = 0; i < participantCount; ++i) {
+        octetSizes[i] = source[i].octetSize;
+    }
+}
+
+static void seerPredictedStepsCommitWrite(SeerPredictedSteps* self, size_t index, size_t participantCount,
+                                          StepId stepId, bool isReplacing)
+{
+    if (self->hasSoa) {
+        seerPredictedStepsFillSoa(self, index, participantCount);
+    }
+    self->inputs[index].participantCount = participantCount;
+    self->stepIds[index] = stepId;
+    self->rawOctetCounts[index] = 0;
+    if (!isReplacing) {
+        self->headStepId++;
+        self->stepsCount++;
+    }
+}
+
+/// Copies the participant inputs into the ring and their payloads into the arena slice for the step.
+/// A payload that is the same as for the participant in the step before is not copied, it is shared with that step.
+/// New steps must be written in order, but a step that is already in the buffer can be replaced.
+int seerPredictedStepsWrite(SeerPredictedSteps* self, const TransmuteInput* input, StepId stepId)
+{
+    size_t totalPayloadOctetCount = 0;
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        totalPayloadOctetCount += seerAlignOctetCount(input->participantInputs[i].octetSize, self->payloadAlignment);
+    }
+
+    bool isReplacing;
+    int indexResult = seerPredictedStepsPrepareWrite(self, stepId, input->participantCount, totalPayloadOctetCount,
+                                                     &isReplacing);
+    if (indexResult < 0) {
+        return indexResult;
+    }
+
+    size_t index = (size_t) indexResult;
+    TransmuteInput* target = &self->inputs[index];
+    uint8_t* payloadTarget = &self->payloadArena[index * self->maxPayloadOctetCountPerStep];
+    size_t payloadOctetCount = 0;
+
+    for (size_t i = 0; i < input->participantCount; ++i) {
+        const TransmuteParticipantInput* source = &input->participantInputs[i];
+        TransmuteParticipantInput* participantTarget = &target->participantInputs[i];
+
+        *participantTarget = *source;
+        if (source->octetSize == 0) {
+            participantTarget->input = 0;
+            continue;
+        }
+
+        const TransmuteParticipantInput* previous = seerPredictedStepsPrevious(self, stepId, i, source->participantId,
+                                                                               source->octetSize);
+        if (previous != 0 && tc_memcmp(previous->input, source->input, source->octetSize) == 0) {
+            participantTarget->input = previous->input;
+        } else {
+            tc_memcpy_octets(payloadTarget + payloadOctetCount, source->input, source->octetSize);
+            participantTarget->input = payloadTarget + payloadOctetCount;
+        }
+        payloadOctetCount += seerAlignOctetCount(source->octetSize, self->payloadAlignment);
+    }
+
+    seerPredictedStepsCommitWrite(self, index, input->participantCount, stepId, isReplacing);
+
+    return 0;
+}
+
+static bool seerPredictedStepsFragmentsEqual(const SeerGatherParticipant* source, const uint8_t* octets)
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < source->fragmentCount; ++i) {
+        const SeerPayloadFragment* fragment = &source->fragments[i];
+        if (fragment->octetCount > 0 && tc_memcmp(octets + offset, fragment->octets, fragment->octetCount) != 0) {
+            return false;
+        }
+        offset += fragment->octetCount;
+    }
+
+    return true;
+}
+
+/// Same as seerPredictedStepsWrite(), but each participant payload is gathered from fragments straight into the
+/// arena slice for the step.
+int seerPredictedStepsWriteGather(SeerPredictedSteps* self, const SeerGatherParticipant* participants,
+                                  size_t participantCount, StepId stepId)
+{
+    size_t totalPayloadOctetCount = 0;
+    for (size_t i = 0; i < participantCount; ++i) {
+        size_t participantOctetCount = 0;
+        for (size_t j = 0; j < participants[i].fragmentCount; ++j) {
+            participantOctetCount += participants[i].fragments[j].octetCount;
+        }
+        totalPayloadOctetCount += seerAlignOctetCount(participantOctetCount, self->payloadAlignment);
+    }
+
+    bool isReplacing;
+    int indexResult = seerPredictedStepsPrepareWrite(self, stepId, participantCount, totalPayloadOctetCount,
+                                                     &isReplacing);
+    if (indexResult < 0) {
+        return indexResult;
+    }
+
+    size_t index = (size_t) indexResult;
+    TransmuteInput* target = &self->inputs[index];
+    uint8_t* payloadTarget = &self->payloadArena[index * self->maxPayloadOctetCountPerStep];
+    size_t payloadOctetCount = 0;
+
+    for (size_t i = 0; i < participantCount; ++i) {
+        const SeerGatherParticipant* source = &participants[i];
+        TransmuteParticipantInput* participantTarget = &target->participantInputs[i];
+
+        participantTarget->participantId = source->participantId;
+        participantTarget->localPartyId = source->localPartyId;
+        participantTarget->inputType = source->inputType;
+
+        size_t participantOctetCount = 0;
+        for (size_t j = 0; j < source->fragmentCount; ++j) {
+            participantOctetCount += source->fragments[j].octetCount;
+        }
+        participantTarget->octetSize = participantOctetCount;
+        if (participantOctetCount == 0) {
+            participantTarget->input = 0;
+            continue;
+        }
+
+        const TransmuteParticipantInput* previous = seerPredictedStepsPrevious(self, stepId, i, source->participantId,
+                                                                               participantOctetCount);
+        if (previous != 0 && seerPredictedStepsFragmentsEqual(source, previous->input)) {
+            participantTarget->input = previous->input;
+        } else {
+            participantTarget->input = payloadTarget + payloadOctetCount;
+            size_t fragmentOffset = payloadOctetCount;
+            for (size_t j = 0; j < source->fragmentCount; ++j) {
+                const SeerPayloadFragment* fragment = &source->fragments[j];
+                tc_memcpy_octets(payloadTarget + fragmentOffset, fragment->octets, fragment->octetCount);
+                fragmentOffset += fragment->octetCount;
+            }
+        }
+        payloadOctetCount += seerAlignOctetCount(participantOctetCount, self->payloadAlignment);
+    }
+
+    seerPredictedStepsCommitWrite(self, index, participantCount, stepId, isReplacing);
+
+    return 0;
+}
+
+/// Gets the decoded input for the step.
+/// The returned pointer is valid until the step is discarded. The payloads it points to can be shared with the steps
+/// before it, and are valid until steps are discarded.
+/// @return the input or NULL if the step is not in the buffer
+const TransmuteInput* seerPredictedStepsGet(const SeerPredictedSteps* self, StepId stepId)
+{
+    if (self->stepsCount == 0 || stepId < self->tailStepId || stepId >= self->headStepId) {
+        return 0;
+    }
+
+    size_t index = stepId & self->indexMask;
+
+    return &self->inputs[index];
+}
+
+/// Gets the struct of arrays view of the participant inputs for the step. The arrays have the same lifetime as the
+/// input returned by seerPredictedStepsGet().
+/// @return negative if the view is not enabled or the step is not in the buffer
+int seerPredictedStepsGetSoa(const SeerPredictedSteps* self, StepId stepId, SeerParticipantInputsSoa* target)
+{
+    if (!self->hasSoa) {
+        return -2;
+    }
+
+    const TransmuteInput* input = seerPredictedStepsGet(self, stepId);
+    if (input == 0) {
+        return -1;
+    }
+
+    size_t offset = (stepId & self->indexMask) * self->maxParticipantCount;
+    target->participantIds = &self->soaParticipantIds[offset];
+    target->inputTypes = &self->soaInputTypes[offset];
+    target->payloads = &self->soaPayloads[offset];
+    target->octetSizes = &self->soaOctetSizes[offset];
+    target->participantCount = input->participantCount;
+
+    return 0;
+}
+
+/// Gets the decoded inputs for the steps starting at stepId, that are stored next to each other in the ring.
+/// The inputs stop at the last step in the buffer or where the ring wraps around.
+/// @return number of inputs, zero if the step is not in the buffer
+size_t seerPredictedStepsGetConsecutive(const SeerPredictedSteps* self, StepId stepId, size_t maxCount,
+                                        const TransmuteInput** inputs)
+{
+    if (self->stepsCount == 0 || stepId < self->tailStepId || stepId >= self->headStepId) {
+        *inputs = 0;
+        return 0;
+    }
+
+    size_t index = stepId & self->indexMask;
+    size_t count = (size_t) (self->headStepId - stepId);
+    if (count > self->capacity - index) {
+        count = self->capacity - index;
+    }
+    if (count > maxCount) {
+        count = maxCount;
+    }
+
+    *inputs = &self->inputs[index];
+
+    return count;
+}
+
+/// Discards all steps before stepId
+/// @return number of discarded steps
+int seerPredictedStepsDiscardUpTo(SeerPredictedSteps* self, StepId stepId)
+{
+    if (stepId <= self->tailStepId) {
+        return 0;
+    }
+
+    if (stepId >= self->headStepId) {
+        int discardedCount = (int) self->stepsCount;
+        seerPredictedStepsReInit(self, stepId);
+        return discardedCount;
+    }
+
+    // Shared payloads stored in the discarded slices are moved to the steps that still use them
+    for (StepId id = self->tailStepId; id < stepId; ++id) {
+        const TransmuteInput* discarded = &self->inputs[id & self->indexMask];
+        const uint8_t* slice = seerPredictedStepsSlice(self, id);
+        for (size_t i = 0; i < discarded->participantCount; ++i) {
+            const uint8_t* payload = (const uint8_t*) discarded->participantInputs[i].input;
+            if (payload >= slice && payload < slice + self->maxPayloadOctetCountPerStep) {
+                seerPredictedStepsDetachShared(self, id, i);
+            }
+        }
+    }
+
+    size_t discardedCount = (size_t) (stepId - self->tailStepId);
+    self->tailStepId = stepId;
+    self->stepsCount -= discardedCount;
+
+    return (int) discardedCount;
+}
+
+/// Keeps the serialized combined step that the step was decoded from. Must be called after the step is written.
+/// Steps larger than maxRawOctetCount are not kept.
+void seerPredictedStepsSetRaw(SeerPredictedSteps* self, StepId stepId, const uint8_t* octets, size_t octetCount)
+{
+    size_t index = stepId & self->indexMask;
+    if (octetCount > self->maxRawOctetCount) {
+        self->rawOctetCounts[index] = 0;
+        return;
+    }
+
+    tc_memcpy_octets(&self->rawOctets[index * self->maxRawOctetCount], octets, octetCount);
+    self->rawOctetCounts[index] = octetCount;
+}
+
+/// Checks if the step is in the buffer and was decoded from the same serialized combined step.
+bool seerPredictedStepsHasRaw(const SeerPredictedSteps* self, StepId stepId, const uint8_t* octets, size_t octetCount)
+{
+    if (octetCount == 0 || seerPredictedStepsGet(self, stepId) == 0) {
+        return false;
+    }
+
+    size_t index = stepId & self->indexMask;
+    if (self->rawOctetCounts[index] != octetCount) {
+        return false;
+    }
+
+    return tc_memcmp(&self->rawOctets[index * self->maxRawOctetCount], octets, octetCount) == 0;
+}
+
+bool seerTransmuteInputEqual(const TransmuteInput* a, const TransmuteInput* b)
+{
+    if (a->participantCount != b->participantCount) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a->participantCount; ++i) {
+        const TransmuteParticipantInput* first = &a->participantInputs[i];
+        const TransmuteParticipantInput* second = &b->participantInputs[i];
+        if (first->participantId != second->participantId || first->inputType != second->inputType ||
+            first->octetSize != second->octetSize) {
+            return false;
+        }
+        if (first->octetSize > 0 && tc_memcmp(first->input, second->input, first->octetSize) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
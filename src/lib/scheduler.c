@@ -0,0 +1,267 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <imprint/allocator.h>
+#include <seer/scheduler.h>
+
+/// allocatorWithFree is optional. If it is set, it is used instead of allocator and the sessions and the worker
+/// queues are freed in seerSchedulerDestroy().
+void seerSchedulerInit(SeerScheduler* self, struct ImprintAllocator* allocator,
+                       struct ImprintAllocatorWithFree* allocatorWithFree, size_t maxSessionCount, size_t workerCount,
+                       Clog log)
+{
+    CLOG_ASSERT(workerCount > 0, "scheduler needs at least one worker")
+
+    self->allocatorWithFree = allocatorWithFree;
+    if (allocatorWithFree != 0) {
+        allocator = &allocatorWithFree->allocator;
+    }
+
+    self->sessions = IMPRINT_ALLOC_TYPE_COUNT(allocator, SeerSchedulerSession, maxSessionCount);
+    self->sessionCount = 0;
+    self->maxSessionCount = maxSessionCount;
+    self->workers = IMPRINT_ALLOC_TYPE_COUNT(allocator, SeerSchedulerWorker, workerCount);
+    self->workerCount = workerCount;
+    self->startedWorkerCount = 0;
+    self->generation = 0;
+    self->remainingSessionCount = 0;
+    self->stopRequested = false;
+    self->isRunning = false;
+    self->log = log;
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        SeerSchedulerWorker* worker = &self->workers[i];
+        worker->scheduler = self;
+        worker->index = i;
+        worker->stolenCount = 0;
+        worker->queue.sessionIndices = IMPRINT_ALLOC_TYPE_COUNT(allocator, size_t, maxSessionCount);
+        worker->queue.head = 0;
+        worker->queue.tail = 0;
+        seerMutexInit(&worker->queue.mutex);
+    }
+
+    seerMutexInit(&self->mutex);
+    seerConditionInit(&self->wakeUp);
+    seerConditionInit(&self->allDone);
+}
+
+void seerSchedulerDestroy(SeerScheduler* self)
+{
+    seerSchedulerStop(self);
+    for (size_t i = 0; i < self->workerCount; ++i) {
+        seerMutexDestroy(&self->workers[i].queue.mutex);
+    }
+    seerConditionDestroy(&self->allDone);
+    seerConditionDestroy(&self->wakeUp);
+    seerMutexDestroy(&self->mutex);
+
+    if (self->allocatorWithFree == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < self->workerCount; ++i) {
+        IMPRINT_FREE(self->allocatorWithFree, self->workers[i].queue.sessionIndices);
+    }
+    IMPRINT_FREE(self->allocatorWithFree, self->workers);
+    IMPRINT_FREE(self->allocatorWithFree, self->sessions);
+    self->workers = 0;
+    self->sessions = 0;
+    self->sessionCount = 0;
+    self->allocatorWithFree = 0;
+}
+
+static bool seerSchedulerQueueTakeTail(SeerSchedulerQueue* self, size_t* sessionIndex)
+{
+    seerMutexLock(&self->mutex);
+    bool hasSession = self->tail > self->head;
+    if (hasSession) {
+        *sessionIndex = self->sessionIndices[--self->tail];
+    }
+    seerMutexUnlock(&self->mutex);
+
+    return hasSession;
+}
+
+static bool seerSchedulerQueueStealHead(SeerSchedulerQueue* self, size_t* sessionIndex)
+{
+    seerMutexLock(&self->mutex);
+    bool hasSession = self->tail > self->head;
+    if (hasSession) {
+        *sessionIndex = self->sessionIndices[self->head++];
+    }
+    seerMutexUnlock(&self->mutex);
+
+    return hasSession;
+}
+
+static bool seerSchedulerWorkerFindSession(SeerSchedulerWorker* self, size_t* sessionIndex)
+{
+    if (seerSchedulerQueueTakeTail(&self->queue, sessionIndex)) {
+        return true;
+    }
+
+    SeerScheduler* scheduler = self->scheduler;
+    for (size_t i = 1; i < scheduler->workerCount; ++i) {
+        SeerSchedulerWorker* victim = &scheduler->workers[(self->index + i) % scheduler->workerCount];
+        if (seerSchedulerQueueStealHead(&victim->queue, sessionIndex)) {
+            self->stolenCount++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void seerSchedulerSessionUpdate(SeerSchedulerSession* self)
+{
+    MonotonicTimeNanoseconds startedAt = monotonicTimeNanosecondsNow();
+    self->lastUpdateResult = seerUpdate(self->seer);
+    MonotonicTimeNanoseconds updateTime = monotonicTimeNanosecondsNow() - startedAt;
+
+    self->lastUpdateTime = updateTime;
+    self->totalUpdateTime += updateTime;
+    if (updateTime > self->maxUpdateTime) {
+        self->maxUpdateTime = updateTime;
+    }
+    self->updateCount++;
+}
+
+static void seerSchedulerWorkerRun(void* arg)
+{
+    SeerSchedulerWorker* self = (SeerSchedulerWorker*) arg;
+    SeerScheduler* scheduler = self->scheduler;
+    size_t handledGeneration = 0;
+
+    while (true) {
+        seerMutexLock(&scheduler->mutex);
+        while (scheduler->generation == handledGeneration && !scheduler->stopRequested) {
+            seerConditionWait(&scheduler->wakeUp, &scheduler->mutex);
+        }
+        if (scheduler->stopRequested) {
+            seerMutexUnlock(&scheduler->mutex);
+            break;
+        }
+        handledGeneration = scheduler->generation;
+        seerMutexUnlock(&scheduler->mutex);
+
+        size_t updatedCount = 0;
+        size_t sessionIndex;
+        while (seerSchedulerWorkerFindSession(self, &sessionIndex)) {
+            seerSchedulerSessionUpdate(&scheduler->sessions[sessionIndex]);
+            updatedCount++;
+        }
+
+        if (updatedCount > 0) {
+            seerMutexLock(&scheduler->mutex);
+            scheduler->remainingSessionCount -= updatedCount;
+            if (scheduler->remainingSessionCount == 0) {
+                seerConditionSignal(&scheduler->allDone);
+            }
+            seerMutexUnlock(&scheduler->mutex);
+        }
+    }
+}
+
+int seerSchedulerStart(SeerScheduler* self)
+{
+    self->stopRequested = false;
+    for (size_t i = 0; i < self->workerCount; ++i) {
+        int result = seerThreadCreate(&self->workers[i].thread, seerSchedulerWorkerRun, &self->workers[i]);
+        if (result < 0) {
+            CLOG_C_SOFT_ERROR(&self->log, "could not start scheduler worker thread %zu", i)
+            // Joins the workers that were already started
+            seerSchedulerStop(self);
+            return result;
+        }
+        self->startedWorkerCount++;
+    }
+    self->isRunning = true;
+
+    return 0;
+}
+
+void seerSchedulerStop(SeerScheduler* self)
+{
+    seerMutexLock(&self->mutex);
+    self->stopRequested = true;
+    seerConditionBroadcast(&self->wakeUp);
+    seerMutexUnlock(&self->mutex);
+
+    for (size_t i = 0; i < self->startedWorkerCount; ++i) {
+        seerThreadJoin(&self->workers[i].thread);
+    }
+    self->startedWorkerCount = 0;
+    self->isRunning = false;
+}
+
+/// The Seer must stay valid until it is removed. Must not be called during seerSchedulerUpdate().
+/// @return the session index, or negative if the scheduler is full
+int seerSchedulerAdd(SeerScheduler* self, Seer* seer)
+{
+    if (self->sessionCount >= self->maxSessionCount) {
+        CLOG_C_SOFT_ERROR(&self->log, "scheduler is full (%zu sessions)", self->maxSessionCount)
+        return -1;
+    }
+
+    SeerSchedulerSession* session = &self->sessions[self->sessionCount];
+    session->seer = seer;
+    session->lastUpdateResult = 0;
+    session->updateCount = 0;
+    session->lastUpdateTime = 0;
+    session->maxUpdateTime = 0;
+    session->totalUpdateTime = 0;
+
+    return (int) self->sessionCount++;
+}
+
+/// Removes the session by moving the last session into its place, so the index of the last session changes.
+/// Must not be called during seerSchedulerUpdate().
+/// @return negative if the Seer was not found
+int seerSchedulerRemove(SeerScheduler* self, const Seer* seer)
+{
+    for (size_t i = 0; i < self->sessionCount; ++i) {
+        if (self->sessions[i].seer == seer) {
+            self->sessions[i] = self->sessions[--self->sessionCount];
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/// Runs seerUpdate() once for every session, spread over the worker threads, and returns when all are done.
+/// The duration of each update is stored in the session.
+void seerSchedulerUpdate(SeerScheduler* self)
+{
+    if (self->sessionCount == 0) {
+        return;
+    }
+
+    CLOG_ASSERT(self->isRunning, "scheduler must be started")
+
+    // A worker that has not noticed that the previous update is done can already take sessions from the queues, so
+    // the count must be set before they are filled
+    seerMutexLock(&self->mutex);
+    self->remainingSessionCount = self->sessionCount;
+    seerMutexUnlock(&self->mutex);
+
+    for (size_t i = 0; i < self->workerCount; ++i) {
+        SeerSchedulerQueue* queue = &self->workers[i].queue;
+        seerMutexLock(&queue->mutex);
+        queue->head = 0;
+        queue->tail = 0;
+        for (size_t sessionIndex = i; sessionIndex < self->sessionCount; sessionIndex += self->workerCount) {
+            queue->sessionIndices[queue->tail++] = sessionIndex;
+        }
+        seerMutexUnlock(&queue->mutex);
+    }
+
+    seerMutexLock(&self->mutex);
+    self->generation++;
+    seerConditionBroadcast(&self->wakeUp);
+    while (self->remainingSessionCount > 0) {
+        seerConditionWait(&self->allDone, &self->mutex);
+    }
+    seerMutexUnlock(&self->mutex);
+}
@@ -2,72 +2,496 @@
  *  Copyright (c) Peter Bjorklund. All rights reserved.
  *  Licensed under the MIT License. See LICENSE in the project root for license information.
  *--------------------------------------------------------------------------------------------*/
-#include "nimble-steps-serialize/out_serialize.h"
 #include <imprint/allocator.h>
+#include <monotonic-time/monotonic_time.h>
 #include <nimble-steps-serialize/in_serialize.h>
 #include <seer/seer.h>
+#include <tiny-libc/tiny_libc.h>
+
+// Conservative size of the serialized combined step header and of the header for each participant in it
+#define SEER_COMBINED_STEP_OVERHEAD_OCTET_COUNT (4)
+#define SEER_COMBINED_STEP_PARTICIPANT_OVERHEAD_OCTET_COUNT (4)
+
+#if defined SEER_TRACE
+#define SEER_TRACE_ADD(self, type, phase, stepId)                                                                     \
+    if ((self)->trace != 0) {                                                                                          \
+        seerTraceAdd((self)->trace, type, phase, stepId);                                                              \
+    }
+#else
+#define SEER_TRACE_ADD(self, type, phase, stepId)
+#endif
+
+#define SEER_TRACE_BEGIN(self, type, stepId) SEER_TRACE_ADD(self, type, SeerTraceEventPhaseBegin, stepId)
+#define SEER_TRACE_END(self, type, stepId) SEER_TRACE_ADD(self, type, SeerTraceEventPhaseEnd, stepId)
+
+typedef struct SeerEnqueuedStep {
+    StepId stepId;
+    size_t octetCount;
+} SeerEnqueuedStep;
+
+/// Clears all the fields. The optional features (checkpoints, enqueued steps, payload alignment, speculative branches
+/// and the struct of arrays view) are disabled until they are set.
+void seerSetupInit(SeerSetup* self)
+{
+    self->allocator = 0;
+    self->allocatorWithFree = 0;
+    self->maxStepOctetSizeForSingleParticipant = 0;
+    self->maxPlayers = 0;
+    self->maxTicksFromAuthoritative = 0;
+    self->checkpointInterval = 0;
+    self->maxCheckpointOctetSize = 0;
+    self->maxEnqueuedSteps = 0;
+    self->payloadAlignment = 0;
+    self->maxSpeculativeBranchCount = 0;
+    self->useParticipantInputsSoa = false;
+    self->log.config = 0;
+    self->log.constantPrefix = 0;
+}
 
 void seerInit(Seer* self, const SeerCallbackObject callbackObject, SeerSetup setup, StepId stepId)
 {
+    struct ImprintAllocator* allocator = setup.allocatorWithFree != 0 ? &setup.allocatorWithFree->allocator
+                                                                       : setup.allocator;
     self->callbackObject = callbackObject;
+    self->allocatorWithFree = setup.allocatorWithFree;
     self->maxPlayerCount = setup.maxPlayers;
-    self->cachedTransmuteInput.participantInputs = IMPRINT_ALLOC_TYPE_COUNT(setup.allocator, TransmuteParticipantInput,
+    self->cachedTransmuteInput.participantInputs = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteParticipantInput,
                                                                             setup.maxPlayers);
     self->cachedTransmuteInput.participantCount = 0;
-    self->readTempBufferSize = 512;
-    self->readTempBuffer = IMPRINT_ALLOC_TYPE_COUNT(setup.allocator, uint8_t, self->readTempBufferSize);
     self->maxPredictionTicksFromAuthoritative = setup.maxTicksFromAuthoritative;
-    nbsStepsInit(&self->predictedSteps, setup.allocator, setup.maxStepOctetSizeForSingleParticipant * setup.maxPlayers,
-                 setup.log);
-    nbsStepsReInit(&self->predictedSteps, stepId);
-    self->stepId = stepId;
-    self->maxPredictionTickId = (StepId) (self->stepId + self->maxPredictionTicksFromAuthoritative);
+    self->maxCombinedStepOctetCount = SEER_COMBINED_STEP_OVERHEAD_OCTET_COUNT +
+                                      setup.maxPlayers * (setup.maxStepOctetSizeForSingleParticipant +
+                                                          SEER_COMBINED_STEP_PARTICIPANT_OVERHEAD_OCTET_COUNT);
+    // Predicted steps can be added while waiting for the authoritative state, so allow twice the horizon
+    seerPredictedStepsInit(&self->predictedSteps, allocator, setup.maxTicksFromAuthoritative * 2, setup.maxPlayers,
+                           setup.maxStepOctetSizeForSingleParticipant, setup.payloadAlignment,
+                           self->maxCombinedStepOctetCount, setup.useParticipantInputsSoa, setup.log);
+    seerCheckpointsInit(&self->checkpoints, allocator, setup.maxTicksFromAuthoritative, setup.checkpointInterval,
+                        setup.maxCheckpointOctetSize);
+    seerInputPredictorInit(&self->inputPredictor, allocator, setup.maxPlayers,
+                           setup.maxStepOctetSizeForSingleParticipant, setup.payloadAlignment);
+    seerAdaptiveHorizonInit(&self->adaptiveHorizon, setup.maxTicksFromAuthoritative);
+    seerSpeculationInit(&self->speculation, allocator, setup.maxSpeculativeBranchCount, setup.maxPlayers,
+                        setup.maxStepOctetSizeForSingleParticipant);
+    size_t enqueuedStepOctetSize = sizeof(SeerEnqueuedStep) + self->maxCombinedStepOctetCount;
+    enqueuedStepOctetSize = (enqueuedStepOctetSize + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    seerSpscQueueInit(&self->enqueuedSteps, allocator, setup.maxEnqueuedSteps, enqueuedStepOctetSize);
+    seerSpscQueueInit(&self->enqueuedAuthoritativeStepIds, allocator, setup.maxEnqueuedSteps, sizeof(StepId));
+    self->predictedStateHashCapacity = setup.maxTicksFromAuthoritative + 1;
+    self->predictedStateHashes = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint64_t, self->predictedStateHashCapacity);
+    self->predictedStateHashStepIds = IMPRINT_ALLOC_TYPE_COUNT(allocator, StepId, self->predictedStateHashCapacity);
+    self->stats = 0;
+    self->trace = 0;
+    self->recorder = 0;
     self->log = setup.log;
 
-    self->callbackObject.vtbl->copyFromAuthoritativeFn(self->callbackObject.self, stepId);
+    seerReset(self, stepId);
 }
 
+/// Returns the memory to setup.allocatorWithFree. If it was not set, the memory is owned by the allocator and
+/// nothing is freed.
 void seerDestroy(Seer* self)
 {
-    (void) self;
+    if (self->allocatorWithFree == 0) {
+        return;
+    }
+
+    IMPRINT_FREE(self->allocatorWithFree, self->cachedTransmuteInput.participantInputs);
+    seerPredictedStepsDestroy(&self->predictedSteps, self->allocatorWithFree);
+    seerCheckpointsDestroy(&self->checkpoints, self->allocatorWithFree);
+    seerInputPredictorDestroy(&self->inputPredictor, self->allocatorWithFree);
+    seerSpeculationDestroy(&self->speculation, self->allocatorWithFree);
+    seerSpscQueueDestroy(&self->enqueuedSteps, self->allocatorWithFree);
+    seerSpscQueueDestroy(&self->enqueuedAuthoritativeStepIds, self->allocatorWithFree);
+    IMPRINT_FREE(self->allocatorWithFree, self->predictedStateHashes);
+    IMPRINT_FREE(self->allocatorWithFree, self->predictedStateHashStepIds);
+    self->cachedTransmuteInput.participantInputs = 0;
+    self->predictedStateHashes = 0;
+    self->predictedStateHashStepIds = 0;
+    self->allocatorWithFree = 0;
+}
+
+/// Starts over from the authoritative state at stepId, as if seerInit() was called with the same setup, but reuses
+/// all the buffers. The stats, the input predictor setup and the speculation hypotheses are kept.
+/// Must not be called while a SeerWorker is running.
+void seerReset(Seer* self, StepId stepId)
+{
+    seerPredictedStepsReInit(&self->predictedSteps, stepId);
+    seerCheckpointsInvalidateAll(&self->checkpoints);
+    seerInputPredictorReset(&self->inputPredictor);
+    seerSpeculationReset(&self->speculation);
+    seerSpscQueueReset(&self->enqueuedSteps);
+    seerSpscQueueReset(&self->enqueuedAuthoritativeStepIds);
+    self->stepId = stepId;
+    self->maxPredictionTickId = (StepId) (self->stepId + self->adaptiveHorizon.horizonTicks);
+    self->authoritativeStepId = stepId;
+    self->pendingAuthoritativeStepId = stepId;
+    self->hasPendingAuthoritativeStepId = false;
+    self->confirmedStepId = stepId;
+    self->firstMispredictedStepId = stepId;
+    self->hasMispredictedStep = false;
+    self->firstReplacedStepId = stepId;
+    self->hasReplacedStep = false;
+    for (size_t i = 0; i < self->predictedStateHashCapacity; ++i) {
+        self->predictedStateHashStepIds[i] = (StepId) (stepId - 1);
+    }
+
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypeCopyFromAuthoritative, stepId)
+    self->callbackObject.vtbl->copyFromAuthoritativeFn(self->callbackObject.self, stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypeCopyFromAuthoritative, stepId)
+}
+
+/// Starts filling in stats, or stops if stats is NULL. The stats are not cleared, see seerStatsInit().
+void seerSetStats(Seer* self, SeerStats* stats)
+{
+    self->stats = stats;
+}
+
+/// Sets how inputs are predicted for participants that are missing in the predicted steps.
+/// With a predictor, ticks without a predicted step are predicted from the last confirmed inputs (see
+/// seerConfirmStepRaw()) instead of stopping, so the prediction can reach the horizon.
+void seerSetInputPredictor(Seer* self, SeerInputPredictorSetup setup)
+{
+    if (setup.mode == SeerInputPredictorModeCustom) {
+        CLOG_ASSERT(setup.predictParticipantInputFn != 0, "custom input predictor needs a predictParticipantInputFn")
+    }
+    seerInputPredictorSet(&self->inputPredictor, setup);
+}
+
+/// Starts recording events to trace, or stops if trace is NULL. Events are only recorded if Seer is compiled with
+/// SEER_TRACE defined.
+void seerSetTrace(Seer* self, SeerTrace* trace)
+{
+    self->trace = trace;
+}
+
+/// Starts recording the predicted and confirmed steps, the authoritative arrivals and the updates, or stops if
+/// recorder is NULL. See SeerPlayer for playing the capture back.
+void seerSetRecorder(Seer* self, SeerRecorder* recorder)
+{
+    self->recorder = recorder;
+}
+
+/// Lets the prediction horizon shrink and grow between setup.minTicks and setup.maxTicks, depending on how far behind
+/// the authoritative states arrive and how long the prediction ticks take. The horizon can never be larger than
+/// maxTicksFromAuthoritative, since that decides the size of the buffers.
+void seerSetAdaptiveHorizon(Seer* self, SeerAdaptiveHorizonSetup setup)
+{
+    if (setup.maxTicks > self->maxPredictionTicksFromAuthoritative) {
+        setup.maxTicks = self->maxPredictionTicksFromAuthoritative;
+    }
+    seerAdaptiveHorizonSet(&self->adaptiveHorizon, setup);
+    self->maxPredictionTickId = (StepId) (self->authoritativeStepId + self->adaptiveHorizon.horizonTicks);
+}
+
+static MonotonicTimeNanoseconds seerStatsNow(const Seer* self)
+{
+    return self->stats != 0 ? monotonicTimeNanosecondsNow() : 0;
+}
+
+static MonotonicTimeNanoseconds seerTickCostNow(const Seer* self)
+{
+    return (self->stats != 0 || self->adaptiveHorizon.isEnabled) ? monotonicTimeNanosecondsNow() : 0;
+}
+
+static void seerAddTickCost(Seer* self, MonotonicTimeNanoseconds startedAt, size_t tickCount)
+{
+    if (!self->adaptiveHorizon.isEnabled || tickCount == 0) {
+        return;
+    }
+
+    MonotonicTimeNanoseconds elapsed = monotonicTimeNanosecondsNow() - startedAt;
+    seerAdaptiveHorizonAddTickCost(&self->adaptiveHorizon, elapsed / (MonotonicTimeNanoseconds) tickCount);
+}
+
+static void seerCallCopyFromAuthoritative(Seer* self, StepId stepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerStatsNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypeCopyFromAuthoritative, stepId)
+    self->callbackObject.vtbl->copyFromAuthoritativeFn(self->callbackObject.self, stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypeCopyFromAuthoritative, stepId)
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->copyFromAuthoritative, startedAt);
+    }
+}
+
+static void seerCallPredictionTick(Seer* self, const TransmuteInput* input, StepId stepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerTickCostNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypePredictionTick, stepId)
+    self->callbackObject.vtbl->predictionTickFn(self->callbackObject.self, input, stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypePredictionTick, stepId)
+    seerAddTickCost(self, startedAt, 1);
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->predictionTick, startedAt);
+        self->stats->predictedTickCount++;
+    }
+}
+
+static void seerCallPredictionTicks(Seer* self, const TransmuteInput* inputs, size_t count, StepId firstStepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerTickCostNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypePredictionTicks, firstStepId)
+    self->callbackObject.vtbl->predictionTicksFn(self->callbackObject.self, inputs, count, firstStepId);
+    SEER_TRACE_END(self, SeerTraceEventTypePredictionTicks, firstStepId)
+    seerAddTickCost(self, startedAt, count);
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->predictionTick, startedAt);
+        self->stats->predictedTickCount += count;
+    }
+}
+
+static void seerCallPostPredictionTicks(Seer* self)
+{
+    MonotonicTimeNanoseconds startedAt = seerStatsNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypePostPredictionTicks, self->stepId)
+    self->callbackObject.vtbl->postPredictionTicksFn(self->callbackObject.self);
+    SEER_TRACE_END(self, SeerTraceEventTypePostPredictionTicks, self->stepId)
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->postPredictionTicks, startedAt);
+    }
+}
+
+static uint64_t seerCallPredictedStateHash(Seer* self, StepId stepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerStatsNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypePredictedStateHash, stepId)
+    uint64_t hash = self->callbackObject.vtbl->predictedStateHashFn(self->callbackObject.self, stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypePredictedStateHash, stepId)
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->predictedStateHash, startedAt);
+    }
+    return hash;
+}
+
+static uint64_t seerCallAuthoritativeStateHash(const Seer* self, StepId stepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerStatsNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypeAuthoritativeStateHash, stepId)
+    uint64_t hash = self->callbackObject.vtbl->authoritativeStateHashFn(self->callbackObject.self, stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypeAuthoritativeStateHash, stepId)
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->authoritativeStateHash, startedAt);
+    }
+    return hash;
 }
 
+static int seerCallSaveSnapshot(Seer* self, uint8_t* target, size_t maxOctetCount, StepId stepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerStatsNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypeSaveSnapshot, stepId)
+    int octetCount = self->callbackObject.vtbl->saveSnapshotFn(self->callbackObject.self, target, maxOctetCount,
+                                                               stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypeSaveSnapshot, stepId)
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->saveSnapshot, startedAt);
+    }
+    return octetCount;
+}
+
+static void seerCallLoadSnapshot(Seer* self, const uint8_t* source, size_t octetCount, StepId stepId)
+{
+    MonotonicTimeNanoseconds startedAt = seerStatsNow(self);
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypeLoadSnapshot, stepId)
+    self->callbackObject.vtbl->loadSnapshotFn(self->callbackObject.self, source, octetCount, stepId);
+    SEER_TRACE_END(self, SeerTraceEventTypeLoadSnapshot, stepId)
+    if (self->stats != 0) {
+        seerStatsCallbackAdd(&self->stats->loadSnapshot, startedAt);
+    }
+}
+
+/// Records that the authoritative state has advanced to stepId. It is applied at the start of the next update, so if
+/// several authoritative states arrive before that, only the newest one is copied.
 void seerAuthoritativeGotNewState(Seer* self, StepId stepId)
 {
-    // Check that the stepId is greater than that has been set previously
+    if (self->recorder != 0) {
+        seerRecorderAuthoritativeGotNewState(self->recorder, stepId);
+    }
+
+    if (self->hasPendingAuthoritativeStepId) {
+        if (stepId <= self->pendingAuthoritativeStepId) {
+            return;
+        }
+        if (self->stats != 0) {
+            self->stats->coalescedAuthoritativeCount++;
+        }
+    } else if (stepId <= self->authoritativeStepId) {
+        return;
+    }
+
+    SEER_TRACE_ADD(self, SeerTraceEventTypeAuthoritativeArrived, SeerTraceEventPhaseInstant, stepId)
+    self->pendingAuthoritativeStepId = stepId;
+    self->hasPendingAuthoritativeStepId = true;
+}
+
+/// Checks if the predicted ticks up to (but not including) stepId were all simulated with inputs that have
+/// been confirmed by the authoritative side. In that case the predicted state is already what the authoritative
+/// state would have produced, and there is no need to copy it and resimulate.
+static bool seerPredictionIsStillValid(const Seer* self, StepId stepId)
+{
+    if (self->stepId < stepId) {
+        return false;
+    }
+
+    if (self->confirmedStepId < stepId) {
+        return false;
+    }
+
+    if (self->hasReplacedStep && self->firstReplacedStepId < stepId) {
+        return false;
+    }
+
+    return !(self->hasMispredictedStep && self->firstMispredictedStepId < stepId);
+}
+
+/// Records the hash of the predicted state after the ticks from firstTickId up to tickId. When the ticks were
+/// predicted in one batch, only the state after the batch is known, so the ticks inside it are marked as not recorded.
+static void seerRecordPredictedStateHash(Seer* self, StepId firstTickId, StepId tickId)
+{
+    if (self->callbackObject.vtbl->predictedStateHashFn == 0) {
+        return;
+    }
+
+    // Authoritative states that are not after the current one are ignored, so that step id is never compared
+    for (StepId skippedTickId = (StepId) (firstTickId + 1); skippedTickId < tickId; ++skippedTickId) {
+        self->predictedStateHashStepIds[skippedTickId % self->predictedStateHashCapacity] = self->authoritativeStepId;
+    }
+
+    size_t index = tickId % self->predictedStateHashCapacity;
+    self->predictedStateHashes[index] = seerCallPredictedStateHash(self, tickId);
+    self->predictedStateHashStepIds[index] = tickId;
+}
+
+/// The ticks after stepId are about to be predicted again, so the hashes recorded for them are for a prediction that
+/// was thrown away.
+static void seerForgetPredictedStateHashesAfter(Seer* self, StepId stepId)
+{
+    for (size_t i = 0; i < self->predictedStateHashCapacity; ++i) {
+        if (self->predictedStateHashStepIds[i] > stepId) {
+            self->predictedStateHashStepIds[i] = self->authoritativeStepId;
+        }
+    }
+}
+
+/// Checks if the predicted state that was recorded for stepId has the same hash as the authoritative state.
+static bool seerPredictedStateHashMatches(const Seer* self, StepId stepId)
+{
+    if (self->callbackObject.vtbl->predictedStateHashFn == 0 ||
+        self->callbackObject.vtbl->authoritativeStateHashFn == 0) {
+        return false;
+    }
+
+    if (self->stepId < stepId) {
+        return false;
+    }
+
+    size_t index = stepId % self->predictedStateHashCapacity;
+    if (self->predictedStateHashStepIds[index] != stepId) {
+        return false;
+    }
+
+    uint64_t authoritativeHash = seerCallAuthoritativeStateHash(self, stepId);
+
+    return authoritativeHash == self->predictedStateHashes[index];
+}
+
+/// If the prediction was wrong, but one of the speculative branches was simulated with the confirmed inputs up to
+/// stepId, the branch becomes the predicted state instead of copying the authoritative state and simulating again.
+static bool seerCommitSpeculativeBranch(Seer* self, StepId stepId)
+{
+    if (!seerSpeculationIsEnabled(&self->speculation) || self->confirmedStepId < stepId) {
+        return false;
+    }
+
+    int branchIndex = seerSpeculationFindMatchingBranch(&self->speculation, stepId, self->authoritativeStepId);
+    if (branchIndex < 0) {
+        return false;
+    }
+
+    StepId branchStepId = self->speculation.branches[branchIndex].stepId;
+    CLOG_C_VERBOSE(&self->log, "speculative branch %d was correct up to %08X, continue from %08X", branchIndex, stepId,
+                   branchStepId)
+    self->callbackObject.vtbl->selectBranchFn(self->callbackObject.self, (size_t) branchIndex, branchStepId);
+    self->stepId = branchStepId;
+
+    // The checkpoints, the state hashes and the mispredictions were for the prediction that was thrown away
+    seerCheckpointsInvalidateAll(&self->checkpoints);
+    for (size_t i = 0; i < self->predictedStateHashCapacity; ++i) {
+        self->predictedStateHashStepIds[i] = (StepId) (stepId - 1);
+    }
+    self->hasMispredictedStep = false;
+    self->hasReplacedStep = false;
+    if (!seerSpeculationCommit(&self->speculation, (size_t) branchIndex, stepId)) {
+        self->firstMispredictedStepId = stepId;
+        self->hasMispredictedStep = true;
+    }
+
+    if (self->stats != 0) {
+        self->stats->speculativeBranchCommitCount++;
+    }
+
+    return true;
+}
+
+static void seerApplyAuthoritativeState(Seer* self, StepId stepId)
+{
     // Check if we have steps for this step in the buffer
     // Discard older steps
 
-    int discardedStepCount = nbsStepsDiscardUpTo(&self->predictedSteps, stepId);
+    bool predictionIsStillValid = seerPredictionIsStillValid(self, stepId) ||
+                                  seerPredictedStateHashMatches(self, stepId) ||
+                                  seerCommitSpeculativeBranch(self, stepId);
+
+    if (self->adaptiveHorizon.isEnabled) {
+        // How many predicted steps the caller was ahead of the authoritative state when it arrived
+        StepId predictedHeadStepId = self->predictedSteps.headStepId;
+        size_t latencyTicks = predictedHeadStepId > stepId ? (size_t) (predictedHeadStepId - stepId) : 0U;
+        seerAdaptiveHorizonAddLatency(&self->adaptiveHorizon, latencyTicks);
+    }
+
+    int discardedStepCount = seerPredictedStepsDiscardUpTo(&self->predictedSteps, stepId);
 #if defined CLOG_LOG_ENABLED
     CLOG_C_VERBOSE(&self->log, "at stepId: %08X discarded %d steps, predicted count is now: %zu", stepId,
                    discardedStepCount, self->predictedSteps.stepsCount)
 #else
     (void) discardedStepCount;
 #endif
+    self->authoritativeStepId = stepId;
+    self->maxPredictionTickId = (StepId) (self->authoritativeStepId + self->adaptiveHorizon.horizonTicks);
+    if (self->confirmedStepId < stepId) {
+        self->confirmedStepId = stepId;
+    }
+    if (self->hasMispredictedStep && self->firstMispredictedStepId < stepId) {
+        self->hasMispredictedStep = false;
+    }
+    if (self->hasReplacedStep && (!predictionIsStillValid || self->firstReplacedStepId < stepId)) {
+        self->hasReplacedStep = false;
+    }
+    seerSpeculationRestart(&self->speculation, stepId);
+
+    if (self->stats != 0) {
+        size_t resimulatedTickCount = (!predictionIsStillValid && self->stepId > stepId)
+                                          ? (size_t) (self->stepId - stepId)
+                                          : 0U;
+        seerStatsAddResimulatedTicks(self->stats, resimulatedTickCount);
+    }
+
+    if (predictionIsStillValid) {
+#if defined CLOG_LOG_ENABLED
+        CLOG_C_VERBOSE(&self->log, "prediction up to %08X was correct, continue from %08X", stepId, self->stepId)
+#endif
+        return;
+    }
+
     self->stepId = stepId;
-    self->maxPredictionTickId = (StepId) (self->stepId + self->maxPredictionTicksFromAuthoritative);
+    seerCheckpointsInvalidateAll(&self->checkpoints);
+    seerForgetPredictedStateHashesAfter(self, stepId);
+    seerSpeculationTruncateCommitted(&self->speculation, stepId);
 
 #if defined CLOG_LOG_ENABLED
     CLOG_C_VERBOSE(&self->log, "callback: copyFromAuthoritativeFn")
 #endif
-    self->callbackObject.vtbl->copyFromAuthoritativeFn(self->callbackObject.self, stepId);
-}
-
-static NimbleSerializeStepType toStepType(TransmuteParticipantInputType inputType)
-{
-    switch (inputType) {
-        case TransmuteParticipantInputTypeNormal:
-            return NimbleSerializeStepTypeNormal;
-        case TransmuteParticipantInputTypeNoInputInTime:
-            return NimbleSerializeStepTypeStepNotProvidedInTime;
-        case TransmuteParticipantInputTypeWaitingForReJoin:
-            return NimbleSerializeStepTypeWaitingForReJoin;
-        case TransmuteParticipantInputTypeJoined:
-            return NimbleSerializeStepTypeJoined;
-        case TransmuteParticipantInputTypeLeft:
-            return NimbleSerializeStepTypeLeft;
-    }
+    seerCallCopyFromAuthoritative(self, stepId);
 }
 
 static TransmuteParticipantInputType fromStepType(NimbleSerializeStepType inputType)
@@ -86,90 +510,290 @@ static TransmuteParticipantInputType fromStepType(NimbleSerializeStepType inputT
     }
 }
 
-int seerUpdate(Seer* self)
+/// If an already predicted tick got a new input, the prediction must continue from before that tick.
+/// Restores the nearest checkpoint, or the authoritative state if there is no checkpoint to use.
+static void seerRollbackToReplacedStep(Seer* self)
+{
+    if (!self->hasReplacedStep) {
+        return;
+    }
+
+    self->hasReplacedStep = false;
+    if (self->firstReplacedStepId >= self->stepId) {
+        return;
+    }
+
+    const SeerCheckpoint* checkpoint = seerCheckpointsFindNearest(&self->checkpoints, self->firstReplacedStepId,
+                                                                  self->authoritativeStepId);
+    seerCheckpointsInvalidateAfter(&self->checkpoints, self->firstReplacedStepId);
+
+    if (checkpoint != 0) {
+        CLOG_C_VERBOSE(&self->log, "step %08X was replaced, restore checkpoint %08X", self->firstReplacedStepId,
+                       checkpoint->stepId)
+        seerCallLoadSnapshot(self, checkpoint->octets, checkpoint->octetCount, checkpoint->stepId);
+        self->stepId = checkpoint->stepId;
+        seerForgetPredictedStateHashesAfter(self, self->stepId);
+        seerSpeculationTruncateCommitted(&self->speculation, self->stepId);
+        if (self->stats != 0) {
+            self->stats->checkpointRestoreCount++;
+        }
+        return;
+    }
+
+    CLOG_C_VERBOSE(&self->log, "step %08X was replaced, no checkpoint so copy from authoritative",
+                   self->firstReplacedStepId)
+    self->stepId = self->authoritativeStepId;
+    seerForgetPredictedStateHashesAfter(self, self->stepId);
+    seerSpeculationTruncateCommitted(&self->speculation, self->stepId);
+    seerCallCopyFromAuthoritative(self, self->authoritativeStepId);
+}
+
+static void seerSaveCheckpoint(Seer* self)
+{
+    SeerCheckpoint* checkpoint = seerCheckpointsSlot(&self->checkpoints, self->stepId);
+
+    int octetCount = seerCallSaveSnapshot(self, checkpoint->octets, self->checkpoints.maxOctetSize, self->stepId);
+    if (octetCount < 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "could not save snapshot for %08X", self->stepId)
+        checkpoint->isValid = false;
+        return;
+    }
+
+    checkpoint->stepId = self->stepId;
+    checkpoint->octetCount = (size_t) octetCount;
+    checkpoint->isValid = true;
+}
+
+/// Applies everything that was enqueued from other threads since the last update.
+static void seerDrainEnqueued(Seer* self)
+{
+    if (self->enqueuedSteps.capacity == 0) {
+        return;
+    }
+
+    const SeerEnqueuedStep* enqueuedStep;
+    while ((enqueuedStep = (const SeerEnqueuedStep*) seerSpscQueuePeek(&self->enqueuedSteps)) != 0) {
+        const uint8_t* combinedStep = (const uint8_t*) (enqueuedStep + 1);
+        seerAddPredictedStepRaw(self, combinedStep, enqueuedStep->octetCount, enqueuedStep->stepId);
+        seerSpscQueuePop(&self->enqueuedSteps);
+    }
+
+    const StepId* authoritativeStepId;
+    while ((authoritativeStepId = (const StepId*) seerSpscQueuePeek(&self->enqueuedAuthoritativeStepIds)) != 0) {
+        StepId stepId = *authoritativeStepId;
+        seerSpscQueuePop(&self->enqueuedAuthoritativeStepIds);
+        seerAuthoritativeGotNewState(self, stepId);
+    }
+}
+
+/// Finds how many ticks, starting at the current one, that can be handed to predictionTicksFn in one call.
+/// A batch stops at the horizon, at the end of the consecutive predicted steps, before a tick that needs a checkpoint
+/// and before a tick that needs inputs from the input predictor. The predicted state hash is only recorded after each
+/// batch.
+static size_t seerBatchCount(Seer* self)
+{
+    if (self->callbackObject.vtbl->predictionTicksFn == 0) {
+        return 0;
+    }
+
+    const TransmuteInput* inputs;
+    size_t count = seerPredictedStepsGetConsecutive(&self->predictedSteps, self->stepId,
+                                                    (size_t) (self->maxPredictionTickId - self->stepId), &inputs);
+
+    for (size_t i = 1; i < count; ++i) {
+        StepId tickId = (StepId) (self->stepId + i);
+        if (seerCheckpointsShouldSave(&self->checkpoints, tickId)) {
+            return i;
+        }
+        size_t synthesizedCount;
+        seerInputPredictorPredict(&self->inputPredictor, &inputs[i], tickId, &synthesizedCount);
+        if (synthesizedCount > 0) {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+static int seerPredictUntil(Seer* self, bool hasDeadline, MonotonicTimeNanoseconds deadline, bool hasStopStepId,
+                            StepId stopStepId)
 {
     // We don't want to predict too far in the future, for several reasons
     // The predictions have the risk of being so far from the actual truth, so the reconciliation with the authoritative
     // state will look jarring and/or erroneous.
 
+    seerDrainEnqueued(self);
+    if (self->hasPendingAuthoritativeStepId) {
+        self->hasPendingAuthoritativeStepId = false;
+        seerApplyAuthoritativeState(self, self->pendingAuthoritativeStepId);
+    }
+    seerRollbackToReplacedStep(self);
+    // The adaptive horizon can change with the tick cost between authoritative states
+    self->maxPredictionTickId = (StepId) (self->authoritativeStepId + self->adaptiveHorizon.horizonTicks);
+
     while (true) {
         if (self->stepId >= self->maxPredictionTickId) {
-            CLOG_C_INFO(&self->log,
-                        "we can not predict further from the last authoritative state. The prediction will be too "
-                        "costly to simulate or uncertainty will be too high"
-                        "max: %04X actual: %04X maxDeltaTicks: %zu",
-                        self->maxPredictionTickId, self->stepId, self->maxPredictionTicksFromAuthoritative)
+            CLOG_C_VERBOSE(&self->log,
+                           "we can not predict further from the last authoritative state. The prediction will be too "
+                           "costly to simulate or uncertainty will be too high"
+                           "max: %04X actual: %04X maxDeltaTicks: %zu",
+                           self->maxPredictionTickId, self->stepId, self->adaptiveHorizon.horizonTicks)
 
-            self->callbackObject.vtbl->postPredictionTicksFn(self->callbackObject.self);
+            if (self->stats != 0) {
+                self->stats->horizonCapHitCount++;
+            }
+            seerCallPostPredictionTicks(self);
             return 1;
         }
 
-        int infoIndex = nbsStepsGetIndexForStep(&self->predictedSteps, self->stepId);
-        if (infoIndex < 0) {
+        size_t synthesizedCount;
+        const TransmuteInput* predictedInput = seerInputPredictorPredict(
+            &self->inputPredictor, seerPredictedStepsGet(&self->predictedSteps, self->stepId), self->stepId,
+            &synthesizedCount);
+        if (predictedInput == 0) {
             CLOG_C_VERBOSE(&self->log, "stop predicting, since we don't have a predicted input for step %04X",
                            self->stepId)
-            self->callbackObject.vtbl->postPredictionTicksFn(self->callbackObject.self);
+            if (self->stats != 0) {
+                self->stats->missingInputStopCount++;
+            }
+            seerCallPostPredictionTicks(self);
             return 0;
         }
 
-        int payloadOctetCount = nbsStepsReadAtIndex(&self->predictedSteps, infoIndex, self->readTempBuffer,
-                                                    self->readTempBufferSize);
-        if (payloadOctetCount <= 0) {
-            CLOG_C_SOFT_ERROR(&self->log, "can not read index")
-            return payloadOctetCount;
+        if (self->stats != 0) {
+            self->stats->synthesizedInputCount += synthesizedCount;
         }
 
-        NimbleStepsOutSerializeLocalParticipants participants;
-
-        nbsStepsInSerializeStepsForParticipantsFromOctets(&participants, self->readTempBuffer,
-                                                          (size_t) payloadOctetCount);
 #if defined SEER_LOG_EXTRA_INFO
-        CLOG_C_VERBOSE(&self->log, "read predicted step %08X octetCount: %d", self->stepId, payloadOctetCount)
-        for (size_t i = 0; i < participants.participantCount; ++i) {
-            CLOG_EXECUTE(NimbleStepsOutSerializeLocalParticipant* participant = &participants.participants[i];)
+        CLOG_C_VERBOSE(&self->log, "read predicted step %08X", self->stepId)
+        for (size_t i = 0; i < predictedInput->participantCount; ++i) {
+            CLOG_EXECUTE(const TransmuteParticipantInput* participant = &predictedInput->participantInputs[i];)
             CLOG_C_VERBOSE(&self->log, " participant %d octetCount: %zu", participant->participantId,
-                           participant->payloadCount)
+                           participant->octetSize)
         }
-
 #endif
-        if (participants.participantCount > self->maxPlayerCount) {
-            CLOG_C_SOFT_ERROR(&self->log, "Too many participants %zu", participants.participantCount)
-            return -99;
-        }
-        self->cachedTransmuteInput.participantCount = participants.participantCount;
-        for (size_t i = 0U; i < participants.participantCount; ++i) {
-            NimbleStepsOutSerializeLocalParticipant* participant = &participants.participants[i];
-            if (participant->payload == 0 || participant->payloadCount == 0) {
-                // CLOG_C_ERROR(&self->log, "illegal participant payload")
-            }
-            TransmuteParticipantInput* cachedTarget = &self->cachedTransmuteInput.participantInputs[i];
-            cachedTarget->participantId = participant->participantId;
-            cachedTarget->localPartyId = participant->localPartyId;
-            cachedTarget->input = participant->payload;
-            cachedTarget->octetSize = participant->payloadCount;
-            cachedTarget->inputType = fromStepType(participant->stepType);
+
+        if (self->stepId != self->authoritativeStepId && seerCheckpointsShouldSave(&self->checkpoints, self->stepId)) {
+            seerSaveCheckpoint(self);
         }
 
-        CLOG_C_VERBOSE(&self->log, "predictionTickFn() %08X", self->stepId)
-        self->callbackObject.vtbl->predictionTickFn(self->callbackObject.self, &self->cachedTransmuteInput,
-                                                    self->stepId);
-        self->stepId++;
+        StepId firstTickId = self->stepId;
+        size_t batchCount = synthesizedCount == 0 ? seerBatchCount(self) : 0;
+        if (batchCount > 1) {
+            CLOG_C_VERBOSE(&self->log, "predictionTicksFn() %08X count: %zu", self->stepId, batchCount)
+            const TransmuteInput* inputs;
+            seerPredictedStepsGetConsecutive(&self->predictedSteps, self->stepId, batchCount, &inputs);
+            seerCallPredictionTicks(self, inputs, batchCount, self->stepId);
+            self->stepId = (StepId) (self->stepId + batchCount);
+        } else {
+            CLOG_C_VERBOSE(&self->log, "predictionTickFn() %08X", self->stepId)
+            seerCallPredictionTick(self, predictedInput, self->stepId);
+            self->stepId++;
+        }
+        seerRecordPredictedStateHash(self, firstTickId, self->stepId);
+
+        if (hasDeadline && monotonicTimeNanosecondsNow() >= deadline) {
+            CLOG_C_VERBOSE(&self->log, "out of time budget, continue predicting from %04X next update", self->stepId)
+            seerCallPostPredictionTicks(self);
+            return 2;
+        }
+
+        if (hasStopStepId && self->stepId >= stopStepId) {
+            CLOG_C_VERBOSE(&self->log, "reached stop step, continue predicting from %04X next update", self->stepId)
+            seerCallPostPredictionTicks(self);
+            return 2;
+        }
+    }
+}
+
+static int seerUpdateUntil(Seer* self, bool hasDeadline, MonotonicTimeNanoseconds deadline, bool hasStopStepId,
+                           StepId stopStepId)
+{
+    SEER_TRACE_BEGIN(self, SeerTraceEventTypeUpdate, self->stepId)
+    int result = seerPredictUntil(self, hasDeadline, deadline, hasStopStepId, stopStepId);
+    SEER_TRACE_END(self, SeerTraceEventTypeUpdate, self->stepId)
+
+    // Recorded after the prediction, so the enqueued steps and authoritative states it drained are recorded before it
+    if (self->recorder != 0) {
+        seerRecorderUpdate(self->recorder, self->stepId, result == 2);
     }
+
+    return result;
+}
+
+int seerUpdate(Seer* self)
+{
+    return seerUpdateUntil(self, false, 0, false, 0);
+}
+
+/// Same as seerUpdate(), but stops when the time budget is spent. At least one tick is always predicted.
+/// The next call continues from the same tick, without copying the authoritative state again.
+/// @return 2 if the time budget ran out, otherwise same as seerUpdate()
+int seerUpdateWithBudget(Seer* self, MonotonicTimeNanoseconds budget)
+{
+    return seerUpdateUntil(self, true, monotonicTimeNanosecondsNow() + budget, false, 0);
+}
+
+/// Same as seerUpdate(), but stops when the prediction has reached stopStepId. At least one tick is always predicted.
+/// Used to play back an update that ran out of its time budget, see SeerPlayer.
+/// @return 2 if the prediction stopped at stopStepId, otherwise same as seerUpdate()
+int seerUpdateUntilStepId(Seer* self, StepId stopStepId)
+{
+    return seerUpdateUntil(self, false, 0, true, stopStepId);
 }
 
 bool seerShouldAddPredictedStepThisTick(const Seer* self)
 {
+    // Uses the buffer size and not the adaptive horizon, so the latency measured from the predicted steps is not
+    // limited by the horizon it decides
     return (self->predictedSteps.stepsCount + 2 < self->maxPredictionTicksFromAuthoritative) &&
-           (self->stepId < self->maxPredictionTickId);
+           (self->stepId < (StepId) (self->authoritativeStepId + self->maxPredictionTicksFromAuthoritative));
+}
+
+/// Called when a new predicted step was written, or one that was already in the buffer was replaced (a late
+/// correction). If the tick was already predicted, with the replaced step or with inputs from the input predictor,
+/// the next update will roll back to before it.
+static void seerPredictedStepWritten(Seer* self, StepId tickId)
+{
+    if (tickId < self->stepId && (!self->hasReplacedStep || tickId < self->firstReplacedStepId)) {
+        self->firstReplacedStepId = tickId;
+        self->hasReplacedStep = true;
+    }
+    seerSpeculationStepReplaced(&self->speculation, tickId);
+
+    if (self->stats != 0) {
+        const TransmuteInput* input = seerPredictedStepsGet(&self->predictedSteps, tickId);
+        const TransmuteInput* previousInput = seerPredictedStepsGet(&self->predictedSteps, (StepId) (tickId - 1));
+        for (size_t i = 0; i < input->participantCount; ++i) {
+            const TransmuteParticipantInput* participant = &input->participantInputs[i];
+            self->stats->storedPayloadOctetCount += participant->octetSize;
+            if (previousInput != 0 && i < previousInput->participantCount && participant->octetSize > 0 &&
+                previousInput->participantInputs[i].input == participant->input) {
+                self->stats->sharedPayloadOctetCount += participant->octetSize;
+            }
+        }
+    }
+}
+
+static int seerWritePredictedStep(Seer* self, const TransmuteInput* input, StepId tickId)
+{
+    int result = seerPredictedStepsWrite(&self->predictedSteps, input, tickId);
+    if (result < 0) {
+        return result;
+    }
+
+    seerPredictedStepWritten(self, tickId);
+
+    return result;
 }
 
 int seerAddPredictedStep(Seer* self, const TransmuteInput* input, StepId tickId)
 {
-    NimbleStepsOutSerializeLocalParticipants data;
+    if (self->recorder != 0) {
+        seerRecorderAddInput(self->recorder, input, tickId);
+    }
 
     for (size_t i = 0; i < input->participantCount; ++i) {
-        const TransmuteParticipantInput* source = &input->participantInputs[i];
-        NimbleStepsOutSerializeLocalParticipant* target = &data.participants[i];
         if (input->participantInputs[i].inputType == TransmuteParticipantInputTypeNormal) {
             CLOG_ASSERT(input->participantInputs[i].input != 0 && input->participantInputs[i].octetSize != 0,
                         "input and octetSize must be non-zero for normal steps")
@@ -177,26 +801,303 @@ int seerAddPredictedStep(Seer* self, const TransmuteInput* input, StepId tickId)
             CLOG_ASSERT(input->participantInputs[i].input == 0 && input->participantInputs[i].octetSize == 0,
                         "input and octetSize must be zero for non-normal steps")
         }
+    }
+
+    return seerWritePredictedStep(self, input, tickId);
+}
+
+/// Gets the stored predicted input for the tick without copying. The input is stored in the predicted steps ring and
+/// stays valid until the step is discarded by a newer authoritative state. The payloads it points to can be shared
+/// with the steps before it, and stay valid until the next authoritative state discards steps.
+/// @return the input, or NULL if there is no predicted step for the tick
+const TransmuteInput* seerGetPredictedInput(const Seer* self, StepId tickId)
+{
+    return seerPredictedStepsGet(&self->predictedSteps, tickId);
+}
 
-        target->participantId = source->participantId;
-        target->localPartyId = 0;
-        target->payload = source->input;
-        target->payloadCount = source->octetSize;
-        target->stepType = toStepType(source->inputType);
+/// Gets the participant inputs of the stored predicted step for the tick as separate arrays for the ids, the input
+/// types, the payloads and the payload sizes, so a VM with many participants can scan them one field at a time.
+/// Needs SeerSetup.useParticipantInputsSoa. Inputs synthesized by the input predictor are not stored, so there is no
+/// view for them. The arrays have the same lifetime as the input from seerGetPredictedInput().
+/// @return negative if the view is not enabled or there is no predicted step for the tick
+int seerGetPredictedInputSoa(const Seer* self, StepId tickId, SeerParticipantInputsSoa* target)
+{
+    return seerPredictedStepsGetSoa(&self->predictedSteps, tickId, target);
+}
+
+/// Same as seerAddPredictedStep(), but each participant payload can be split into fragments. The fragments are copied
+/// directly into the predicted steps ring, so the caller does not have to stage the payloads in one buffer.
+int seerAddPredictedStepGather(Seer* self, const SeerGatherParticipant* participants, size_t participantCount,
+                               StepId tickId)
+{
+    if (self->recorder != 0) {
+        seerRecorderAddGather(self->recorder, participants, participantCount, tickId);
+    }
+
+    int result = seerPredictedStepsWriteGather(&self->predictedSteps, participants, participantCount, tickId);
+    if (result < 0) {
+        return result;
     }
 
-    data.participantCount = input->participantCount;
+    seerPredictedStepWritten(self, tickId);
 
-    ssize_t octetCount = nbsStepsOutSerializeCombinedStep(&data, self->readTempBuffer, self->readTempBufferSize);
-    if (octetCount < 0) {
-        CLOG_ERROR("seerAddPredictedSteps: could not serialize")
-        // return octetCount;
+    return result;
+}
+
+/// Decodes a serialized combined step into target. The participant inputs point into combinedStep.
+static int seerDecodeCombinedStep(Seer* self, TransmuteInput* target, const uint8_t* combinedStep, size_t octetCount)
+{
+    NimbleStepsOutSerializeLocalParticipants participants;
+
+    int readOctetCount = nbsStepsInSerializeStepsForParticipantsFromOctets(&participants, combinedStep, octetCount);
+    if (readOctetCount < 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "could not deserialize combined step")
+        return readOctetCount;
+    }
+
+    if (participants.participantCount > self->maxPlayerCount) {
+        CLOG_C_SOFT_ERROR(&self->log, "Too many participants %zu", participants.participantCount)
+        return -99;
     }
 
-    return seerAddPredictedStepRaw(self, self->readTempBuffer, (size_t) octetCount, tickId);
+    if (self->stats != 0) {
+        self->stats->deserializedOctetCount += (size_t) readOctetCount;
+    }
+
+    target->participantCount = participants.participantCount;
+    for (size_t i = 0U; i < participants.participantCount; ++i) {
+        const NimbleStepsOutSerializeLocalParticipant* participant = &participants.participants[i];
+        TransmuteParticipantInput* participantTarget = &target->participantInputs[i];
+        participantTarget->participantId = participant->participantId;
+        participantTarget->localPartyId = participant->localPartyId;
+        participantTarget->input = participant->payload;
+        participantTarget->octetSize = participant->payloadCount;
+        participantTarget->inputType = fromStepType(participant->stepType);
+    }
+
+    return readOctetCount;
 }
 
+/// Decodes the combined step once and stores the decoded participant inputs in the predicted steps ring.
+/// Steps are often sent more than once. If the same combined step (compared octet by octet) is already stored for the
+/// tick, it is not decoded again and the prediction is kept.
 int seerAddPredictedStepRaw(Seer* self, const uint8_t* combinedBuffer, size_t octetCount, StepId tickId)
 {
-    return nbsStepsWrite(&self->predictedSteps, tickId, combinedBuffer, octetCount);
+    if (self->recorder != 0) {
+        seerRecorderAddStep(self->recorder, SeerCaptureRecordTypePredictedStep, combinedBuffer, octetCount, tickId);
+    }
+
+    if (seerPredictedStepsHasRaw(&self->predictedSteps, tickId, combinedBuffer, octetCount)) {
+        if (self->stats != 0) {
+            self->stats->duplicateStepCount++;
+        }
+        return 0;
+    }
+
+    int result = seerDecodeCombinedStep(self, &self->cachedTransmuteInput, combinedBuffer, octetCount);
+    if (result < 0) {
+        return result;
+    }
+
+    result = seerWritePredictedStep(self, &self->cachedTransmuteInput, tickId);
+    if (result < 0) {
+        return result;
+    }
+
+    seerPredictedStepsSetRaw(&self->predictedSteps, tickId, combinedBuffer, octetCount);
+
+    return result;
+}
+
+/// Thread safe version of seerAddPredictedStepRaw(), the step is applied at the start of the next update.
+/// Can only be called from one thread, but that can be another thread than the one calling seerUpdate().
+int seerEnqueuePredictedStepRaw(Seer* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId)
+{
+    if (octetCount > self->maxCombinedStepOctetCount) {
+        CLOG_C_SOFT_ERROR(&self->log, "combined step is too large to enqueue %zu", octetCount)
+        return -2;
+    }
+
+    SeerEnqueuedStep* enqueuedStep = (SeerEnqueuedStep*) seerSpscQueuePrepareWrite(&self->enqueuedSteps);
+    if (enqueuedStep == 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "enqueued steps are full")
+        return -1;
+    }
+
+    enqueuedStep->stepId = tickId;
+    enqueuedStep->octetCount = octetCount;
+    tc_memcpy_octets((uint8_t*) (enqueuedStep + 1), combinedStep, octetCount);
+    seerSpscQueueCommitWrite(&self->enqueuedSteps);
+
+    return 0;
+}
+
+/// Thread safe version of seerAuthoritativeGotNewState(), the state is applied at the start of the next update.
+/// Can only be called from one thread, but that can be another thread than the one calling seerUpdate().
+int seerEnqueueAuthoritativeGotNewState(Seer* self, StepId stepId)
+{
+    StepId* target = (StepId*) seerSpscQueuePrepareWrite(&self->enqueuedAuthoritativeStepIds);
+    if (target == 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "enqueued authoritative states are full")
+        return -1;
+    }
+
+    *target = stepId;
+    seerSpscQueueCommitWrite(&self->enqueuedAuthoritativeStepIds);
+
+    return 0;
+}
+
+static void seerMarkMispredicted(Seer* self, StepId tickId)
+{
+    if (!self->hasMispredictedStep || tickId < self->firstMispredictedStepId) {
+        self->firstMispredictedStepId = tickId;
+        self->hasMispredictedStep = true;
+    }
+}
+
+/// Compares the authoritative (confirmed) combined step with the predicted step for the same tick.
+/// Confirmed steps must be provided in order, before the authoritative state for the tick after them arrives.
+/// @return 1 if the prediction was correct, 0 if it was mispredicted, negative on error
+int seerConfirmStepRaw(Seer* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId)
+{
+    if (self->recorder != 0) {
+        seerRecorderAddStep(self->recorder, SeerCaptureRecordTypeConfirmedStep, combinedStep, octetCount, tickId);
+    }
+
+    if (tickId < self->confirmedStepId) {
+        return 1;
+    }
+
+    if (tickId != self->confirmedStepId) {
+        CLOG_C_SOFT_ERROR(&self->log, "confirmed steps must be consecutive, expected %08X but got %08X",
+                          self->confirmedStepId, tickId)
+        return -2;
+    }
+
+    self->confirmedStepId++;
+
+    const TransmuteInput* predictedInput = seerPredictedStepsGet(&self->predictedSteps, tickId);
+    if (predictedInput == 0 && !seerInputPredictorIsEnabled(&self->inputPredictor) &&
+        !seerSpeculationIsEnabled(&self->speculation)) {
+        CLOG_C_VERBOSE(&self->log, "confirmed step %08X was never predicted", tickId)
+        seerMarkMispredicted(self, tickId);
+        return 0;
+    }
+
+    int result = seerDecodeCombinedStep(self, &self->cachedTransmuteInput, combinedStep, octetCount);
+    if (result < 0) {
+        return result;
+    }
+
+    if (seerInputPredictorIsEnabled(&self->inputPredictor)) {
+        seerInputPredictorConfirmed(&self->inputPredictor, &self->cachedTransmuteInput, tickId);
+    }
+
+    if (seerSpeculationIsEnabled(&self->speculation)) {
+        // Ticks that a committed branch simulated must be compared with the hypothesis, not the predicted step
+        int committedResult = seerSpeculationConfirmed(&self->speculation, predictedInput,
+                                                       &self->cachedTransmuteInput, tickId);
+        if (committedResult == 0) {
+            CLOG_C_VERBOSE(&self->log, "step %08X was mispredicted by the speculative branch", tickId)
+            seerMarkMispredicted(self, tickId);
+        }
+        if (committedResult >= 0) {
+            return committedResult;
+        }
+    }
+
+    // Synthesized inputs are not stored in the predicted steps, so a tick that used them is always treated as
+    // mispredicted
+    if (predictedInput == 0) {
+        CLOG_C_VERBOSE(&self->log, "confirmed step %08X was never predicted", tickId)
+        seerMarkMispredicted(self, tickId);
+        return 0;
+    }
+
+    if (!seerTransmuteInputEqual(predictedInput, &self->cachedTransmuteInput)) {
+        CLOG_C_VERBOSE(&self->log, "step %08X was mispredicted", tickId)
+        seerMarkMispredicted(self, tickId);
+        return 0;
+    }
+
+    return 1;
+}
+
+/// Speculates on the input of participantId, by simulating one branch for each hypothesized input from the
+/// authoritative state, next to the normal prediction. The other participants use the predicted steps. When the
+/// authoritative state arrives and the normal prediction was wrong, a branch that used the confirmed inputs is selected
+/// with selectBranchFn instead of copying the authoritative state and simulating again.
+/// Works best when the participant has few plausible inputs, e.g. held buttons in a fighting game.
+/// A branchCount of zero stops speculating.
+/// @return negative on error
+int seerSetSpeculation(Seer* self, uint8_t participantId, const SeerPayloadFragment* hypotheses, size_t branchCount)
+{
+    const SeerCallbackObjectVtbl* vtbl = self->callbackObject.vtbl;
+    if (branchCount > 0 &&
+        (vtbl->branchCopyFromAuthoritativeFn == 0 || vtbl->branchTickFn == 0 || vtbl->selectBranchFn == 0)) {
+        CLOG_C_SOFT_ERROR(&self->log, "speculation needs the branch callbacks")
+        return -1;
+    }
+
+    // The hypotheses for the ticks that a committed branch simulated are about to be overwritten
+    if (self->speculation.committedFromStepId < self->speculation.committedUntilStepId) {
+        seerMarkMispredicted(self, self->speculation.committedFromStepId);
+    }
+
+    int result = seerSpeculationSet(&self->speculation, participantId, hypotheses, branchCount);
+    if (result < 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "could not speculate with %zu branches", branchCount)
+    }
+
+    return result;
+}
+
+/// Simulates the branch from the authoritative state up to the tick that the prediction has reached, with the
+/// predicted steps (the input predictor is never used for branches).
+/// Different branches can be updated at the same time on different threads, e.g. one branch on each worker, but not
+/// at the same time as any other Seer function.
+/// @return number of simulated ticks, or negative on error
+int seerUpdateSpeculativeBranch(Seer* self, size_t branchIndex)
+{
+    SeerSpeculation* speculation = &self->speculation;
+    if (branchIndex >= speculation->branchCount) {
+        return -1;
+    }
+
+    SeerSpeculativeBranch* branch = &speculation->branches[branchIndex];
+    if (!branch->isStarted) {
+        self->callbackObject.vtbl->branchCopyFromAuthoritativeFn(self->callbackObject.self, branchIndex,
+                                                                 self->authoritativeStepId);
+        branch->startStepId = self->authoritativeStepId;
+        branch->stepId = self->authoritativeStepId;
+        branch->isStarted = true;
+    }
+
+    int tickCount = 0;
+    while (branch->stepId < self->stepId) {
+        const TransmuteInput* predictedInput = seerPredictedStepsGet(&self->predictedSteps, branch->stepId);
+        if (predictedInput == 0) {
+            break;
+        }
+
+        const TransmuteInput* input = seerSpeculationBranchInput(speculation, branchIndex, predictedInput);
+        self->callbackObject.vtbl->branchTickFn(self->callbackObject.self, branchIndex, input, branch->stepId);
+        branch->stepId++;
+        tickCount++;
+    }
+
+    return tickCount;
+}
+
+/// Updates all speculative branches, one after the other, on the calling thread.
+/// @return number of simulated ticks
+int seerUpdateSpeculativeBranches(Seer* self)
+{
+    int tickCount = 0;
+    for (size_t i = 0; i < self->speculation.branchCount; ++i) {
+        tickCount += seerUpdateSpeculativeBranch(self, i);
+    }
+
+    return tickCount;
 }
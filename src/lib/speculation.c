@@ -0,0 +1,336 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <imprint/allocator.h>
+#include <seer/speculation.h>
+#include <tiny-libc/tiny_libc.h>
+
+// Confirmed steps arrive in order, so a mismatch is tracked as the first and the last tick it happened on. When an
+// authoritative state passes the last one, the branch (or the other participants) agree with the confirmed inputs
+// again from that tick.
+
+void seerSpeculationInit(SeerSpeculation* self, struct ImprintAllocator* allocator, size_t maxBranchCount,
+                         size_t maxParticipantCount, size_t maxOctetSizeForSingleParticipant)
+{
+    self->maxBranchCount = maxBranchCount;
+    self->branchCount = 0;
+    self->participantId = 0;
+    self->maxParticipantCount = maxParticipantCount;
+    self->maxOctetSizeForSingleParticipant = maxOctetSizeForSingleParticipant;
+
+    if (maxBranchCount == 0) {
+        self->branches = 0;
+        self->hypothesisOctets = 0;
+        seerSpeculationReset(self);
+        return;
+    }
+
+    self->branches = IMPRINT_ALLOC_TYPE_COUNT(allocator, SeerSpeculativeBranch, maxBranchCount);
+    self->hypothesisOctets = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t,
+                                                      maxBranchCount * maxOctetSizeForSingleParticipant);
+    TransmuteParticipantInput* participantInputs = IMPRINT_ALLOC_TYPE_COUNT(allocator, TransmuteParticipantInput,
+                                                                            maxBranchCount * maxParticipantCount);
+    for (size_t i = 0; i < maxBranchCount; ++i) {
+        SeerSpeculativeBranch* branch = &self->branches[i];
+        branch->input.participantInputs = &participantInputs[i * maxParticipantCount];
+        branch->input.participantCount = 0;
+        branch->hypothesis = &self->hypothesisOctets[i * maxOctetSizeForSingleParticipant];
+        branch->hypothesisOctetCount = 0;
+    }
+
+    seerSpeculationReset(self);
+}
+
+void seerSpeculationDestroy(SeerSpeculation* self, struct ImprintAllocatorWithFree* allocatorWithFree)
+{
+    if (self->branches != 0) {
+        IMPRINT_FREE(allocatorWithFree, self->branches[0].input.participantInputs);
+        IMPRINT_FREE(allocatorWithFree, self->hypothesisOctets);
+        IMPRINT_FREE(allocatorWithFree, self->branches);
+    }
+    self->branches = 0;
+    self->hypothesisOctets = 0;
+    self->maxBranchCount = 0;
+    self->branchCount = 0;
+}
+
+/// Stops all branches and forgets the confirmed inputs, but keeps the hypotheses.
+void seerSpeculationReset(SeerSpeculation* self)
+{
+    for (size_t i = 0; i < self->maxBranchCount; ++i) {
+        SeerSpeculativeBranch* branch = &self->branches[i];
+        branch->isStarted = false;
+        branch->hasMismatch = false;
+        branch->startStepId = 0;
+        branch->stepId = 0;
+    }
+    self->hasOtherMismatch = false;
+    self->committedBranchIndex = 0;
+    self->committedFromStepId = 0;
+    self->committedUntilStepId = 0;
+}
+
+/// Copies one hypothesized input for the participant for each branch. A branchCount of zero stops speculating.
+/// @return negative if there are too many branches or a hypothesis is too large
+int seerSpeculationSet(SeerSpeculation* self, uint8_t participantId, const SeerPayloadFragment* hypotheses,
+                       size_t branchCount)
+{
+    if (branchCount > self->maxBranchCount) {
+        return -2;
+    }
+
+    for (size_t i = 0; i < branchCount; ++i) {
+        if (hypotheses[i].octetCount > self->maxOctetSizeForSingleParticipant) {
+            return -3;
+        }
+    }
+
+    seerSpeculationReset(self);
+
+    for (size_t i = 0; i < branchCount; ++i) {
+        SeerSpeculativeBranch* branch = &self->branches[i];
+        uint8_t* target = &self->hypothesisOctets[i * self->maxOctetSizeForSingleParticipant];
+        tc_memcpy_octets(target, hypotheses[i].octets, hypotheses[i].octetCount);
+        branch->hypothesisOctetCount = hypotheses[i].octetCount;
+    }
+
+    self->participantId = participantId;
+    self->branchCount = branchCount;
+
+    return 0;
+}
+
+bool seerSpeculationIsEnabled(const SeerSpeculation* self)
+{
+    return self->branchCount > 0;
+}
+
+static void seerSpeculationForgetMismatchesBefore(bool* hasMismatch, StepId* firstMismatchStepId,
+                                                  StepId lastMismatchStepId, StepId stepId)
+{
+    if (!*hasMismatch) {
+        return;
+    }
+
+    if (lastMismatchStepId < stepId) {
+        *hasMismatch = false;
+    } else if (*firstMismatchStepId < stepId) {
+        *firstMismatchStepId = stepId;
+    }
+}
+
+/// All branches must start over from the new authoritative state.
+void seerSpeculationRestart(SeerSpeculation* self, StepId authoritativeStepId)
+{
+    for (size_t i = 0; i < self->branchCount; ++i) {
+        SeerSpeculativeBranch* branch = &self->branches[i];
+        branch->isStarted = false;
+        seerSpeculationForgetMismatchesBefore(&branch->hasMismatch, &branch->firstMismatchStepId,
+                                              branch->lastMismatchStepId, authoritativeStepId);
+    }
+
+    seerSpeculationForgetMismatchesBefore(&self->hasOtherMismatch, &self->firstOtherMismatchStepId,
+                                          self->lastOtherMismatchStepId, authoritativeStepId);
+    if (self->committedFromStepId < authoritativeStepId) {
+        self->committedFromStepId = authoritativeStepId;
+    }
+    if (self->committedUntilStepId < self->committedFromStepId) {
+        self->committedUntilStepId = self->committedFromStepId;
+    }
+}
+
+/// Builds the input for the branch: the predicted input with the speculated participant replaced (or added) with the
+/// hypothesis for the branch. Only touches the branch, so different branches can be built on different threads.
+/// The returned input is valid until the next call for the same branch.
+const TransmuteInput* seerSpeculationBranchInput(SeerSpeculation* self, size_t branchIndex,
+                                                 const TransmuteInput* predictedInput)
+{
+    SeerSpeculativeBranch* branch = &self->branches[branchIndex];
+    TransmuteInput* target = &branch->input;
+    bool hasSpeculatedParticipant = false;
+
+    for (size_t i = 0; i < predictedInput->participantCount; ++i) {
+        TransmuteParticipantInput* participantTarget = &target->participantInputs[i];
+        *participantTarget = predictedInput->participantInputs[i];
+        if (participantTarget->participantId == self->participantId) {
+            participantTarget->inputType = TransmuteParticipantInputTypeNormal;
+            participantTarget->input = branch->hypothesis;
+            participantTarget->octetSize = branch->hypothesisOctetCount;
+            hasSpeculatedParticipant = true;
+        }
+    }
+
+    size_t participantCount = predictedInput->participantCount;
+    if (!hasSpeculatedParticipant && participantCount < self->maxParticipantCount) {
+        TransmuteParticipantInput* participantTarget = &target->participantInputs[participantCount++];
+        participantTarget->participantId = self->participantId;
+        participantTarget->localPartyId = 0;
+        participantTarget->inputType = TransmuteParticipantInputTypeNormal;
+        participantTarget->input = branch->hypothesis;
+        participantTarget->octetSize = branch->hypothesisOctetCount;
+    }
+
+    target->participantCount = participantCount;
+
+    return target;
+}
+
+static bool seerSpeculationParticipantEqual(const TransmuteParticipantInput* a, const TransmuteParticipantInput* b)
+{
+    if (a->participantId != b->participantId || a->inputType != b->inputType || a->octetSize != b->octetSize) {
+        return false;
+    }
+
+    return a->octetSize == 0 || tc_memcmp(a->input, b->input, a->octetSize) == 0;
+}
+
+/// Compares all participants except the speculated one, in order.
+static bool seerSpeculationOthersEqual(const SeerSpeculation* self, const TransmuteInput* a, const TransmuteInput* b)
+{
+    size_t indexA = 0;
+    size_t indexB = 0;
+
+    while (true) {
+        while (indexA < a->participantCount && a->participantInputs[indexA].participantId == self->participantId) {
+            indexA++;
+        }
+        while (indexB < b->participantCount && b->participantInputs[indexB].participantId == self->participantId) {
+            indexB++;
+        }
+
+        if (indexA == a->participantCount || indexB == b->participantCount) {
+            return indexA == a->participantCount && indexB == b->participantCount;
+        }
+
+        if (!seerSpeculationParticipantEqual(&a->participantInputs[indexA], &b->participantInputs[indexB])) {
+            return false;
+        }
+
+        indexA++;
+        indexB++;
+    }
+}
+
+static bool seerSpeculationHypothesisEqual(const SeerSpeculativeBranch* branch,
+                                           const TransmuteParticipantInput* confirmed)
+{
+    if (confirmed == 0 || confirmed->inputType != TransmuteParticipantInputTypeNormal ||
+        confirmed->octetSize != branch->hypothesisOctetCount) {
+        return false;
+    }
+
+    return confirmed->octetSize == 0 || tc_memcmp(confirmed->input, branch->hypothesis, confirmed->octetSize) == 0;
+}
+
+static void seerSpeculationMarkMismatch(bool* hasMismatch, StepId* firstMismatchStepId, StepId* lastMismatchStepId,
+                                        StepId tickId)
+{
+    if (!*hasMismatch) {
+        *firstMismatchStepId = tickId;
+        *hasMismatch = true;
+    }
+    *lastMismatchStepId = tickId;
+}
+
+/// Compares the confirmed input with what each branch simulated. predictedInput can be NULL if there was no predicted
+/// step for the tick.
+/// @return 1 if the tick was simulated by the committed branch with the confirmed input, 0 if it was simulated by the
+/// committed branch with another input, and -1 if the tick was not simulated by the committed branch
+int seerSpeculationConfirmed(SeerSpeculation* self, const TransmuteInput* predictedInput,
+                             const TransmuteInput* confirmedInput, StepId tickId)
+{
+    bool othersMatch = predictedInput != 0 && seerSpeculationOthersEqual(self, predictedInput, confirmedInput);
+    if (!othersMatch) {
+        seerSpeculationMarkMismatch(&self->hasOtherMismatch, &self->firstOtherMismatchStepId,
+                                    &self->lastOtherMismatchStepId, tickId);
+    }
+
+    const TransmuteParticipantInput* confirmed = 0;
+    for (size_t i = 0; i < confirmedInput->participantCount; ++i) {
+        if (confirmedInput->participantInputs[i].participantId == self->participantId) {
+            confirmed = &confirmedInput->participantInputs[i];
+            break;
+        }
+    }
+
+    bool committedMatches = false;
+    for (size_t i = 0; i < self->branchCount; ++i) {
+        SeerSpeculativeBranch* branch = &self->branches[i];
+        bool matches = seerSpeculationHypothesisEqual(branch, confirmed);
+        if (!matches) {
+            seerSpeculationMarkMismatch(&branch->hasMismatch, &branch->firstMismatchStepId,
+                                        &branch->lastMismatchStepId, tickId);
+        }
+        if (i == self->committedBranchIndex) {
+            committedMatches = matches && othersMatch;
+        }
+    }
+
+    if (tickId < self->committedFromStepId || tickId >= self->committedUntilStepId) {
+        return -1;
+    }
+
+    return committedMatches ? 1 : 0;
+}
+
+/// Finds a branch that was started from the previous authoritative state, has simulated at least up to the new one,
+/// and was simulated with the confirmed inputs for all ticks before it.
+/// @return the branch index, or -1 if no branch matches
+int seerSpeculationFindMatchingBranch(const SeerSpeculation* self, StepId authoritativeStepId,
+                                      StepId previousAuthoritativeStepId)
+{
+    if (self->hasOtherMismatch && self->firstOtherMismatchStepId < authoritativeStepId) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < self->branchCount; ++i) {
+        const SeerSpeculativeBranch* branch = &self->branches[i];
+        if (!branch->isStarted || branch->startStepId != previousAuthoritativeStepId ||
+            branch->stepId < authoritativeStepId) {
+            continue;
+        }
+        if (branch->hasMismatch && branch->firstMismatchStepId < authoritativeStepId) {
+            continue;
+        }
+        return (int) i;
+    }
+
+    return -1;
+}
+
+/// Remembers that the ticks from authoritativeStepId up to where the branch has simulated were predicted with the
+/// hypothesis of the branch.
+/// @return false if a tick after authoritativeStepId, that is already confirmed, was simulated with another input
+bool seerSpeculationCommit(SeerSpeculation* self, size_t branchIndex, StepId authoritativeStepId)
+{
+    const SeerSpeculativeBranch* branch = &self->branches[branchIndex];
+    self->committedBranchIndex = branchIndex;
+    self->committedFromStepId = authoritativeStepId;
+    self->committedUntilStepId = branch->stepId;
+
+    return !(branch->hasMismatch && branch->lastMismatchStepId >= authoritativeStepId) &&
+           !(self->hasOtherMismatch && self->lastOtherMismatchStepId >= authoritativeStepId);
+}
+
+/// A predicted step was replaced, so the branches that already simulated it must start over.
+void seerSpeculationStepReplaced(SeerSpeculation* self, StepId tickId)
+{
+    for (size_t i = 0; i < self->branchCount; ++i) {
+        if (tickId < self->branches[i].stepId) {
+            self->branches[i].isStarted = false;
+        }
+    }
+}
+
+/// The prediction was simulated again from stepId, so the ticks after that were no longer predicted by the committed
+/// branch.
+void seerSpeculationTruncateCommitted(SeerSpeculation* self, StepId stepId)
+{
+    if (self->committedUntilStepId > stepId) {
+        self->committedUntilStepId = stepId;
+    }
+    if (self->committedFromStepId > self->committedUntilStepId) {
+        self->committedFromStepId = self->committedUntilStepId;
+    }
+}
@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "atomic.h"
+#include <imprint/allocator.h>
+#include <seer/spsc_queue.h>
+
+// writeCount is only written by the producer and readCount only by the consumer. Both only increase, so the
+// number of queued elements is always writeCount - readCount.
+
+void seerSpscQueueInit(SeerSpscQueue* self, struct ImprintAllocator* allocator, size_t capacity,
+                       size_t elementOctetSize)
+{
+    self->capacity = capacity;
+    self->elementOctetSize = elementOctetSize;
+    self->writeCount = 0;
+    self->readCount = 0;
+    self->octets = capacity > 0 ? IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t, capacity * elementOctetSize) : 0;
+}
+
+void seerSpscQueueDestroy(SeerSpscQueue* self, struct ImprintAllocatorWithFree* allocatorWithFree)
+{
+    if (self->octets != 0) {
+        IMPRINT_FREE(allocatorWithFree, self->octets);
+    }
+    self->octets = 0;
+    self->capacity = 0;
+}
+
+/// Empties the queue. Must not be called while the producer or the consumer is using the queue.
+void seerSpscQueueReset(SeerSpscQueue* self)
+{
+    self->writeCount = 0;
+    self->readCount = 0;
+}
+
+/// Called by the producer. The element is not visible to the consumer until seerSpscQueueCommitWrite().
+/// @return the element to write to, or NULL if the queue is full
+void* seerSpscQueuePrepareWrite(SeerSpscQueue* self)
+{
+    size_t readCount = seerAtomicLoadAcquire(&self->readCount);
+    if (self->writeCount - readCount >= self->capacity) {
+        return 0;
+    }
+
+    return &self->octets[(self->writeCount % self->capacity) * self->elementOctetSize];
+}
+
+void seerSpscQueueCommitWrite(SeerSpscQueue* self)
+{
+    seerAtomicStoreRelease(&self->writeCount, self->writeCount + 1);
+}
+
+/// Called by the consumer.
+/// @return the oldest element, or NULL if the queue is empty
+const void* seerSpscQueuePeek(SeerSpscQueue* self)
+{
+    size_t writeCount = seerAtomicLoadAcquire(&self->writeCount);
+    if (writeCount == self->readCount) {
+        return 0;
+    }
+
+    return &self->octets[(self->readCount % self->capacity) * self->elementOctetSize];
+}
+
+void seerSpscQueuePop(SeerSpscQueue* self)
+{
+    seerAtomicStoreRelease(&self->readCount, self->readCount + 1);
+}
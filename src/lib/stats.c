@@ -0,0 +1,27 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <seer/stats.h>
+#include <tiny-libc/tiny_libc.h>
+
+void seerStatsInit(SeerStats* self)
+{
+    tc_mem_clear_type(self);
+}
+
+void seerStatsAddResimulatedTicks(SeerStats* self, size_t resimulatedTickCount)
+{
+    size_t bucket = resimulatedTickCount;
+    if (bucket >= SEER_STATS_RESIMULATED_TICKS_HISTOGRAM_SIZE) {
+        bucket = SEER_STATS_RESIMULATED_TICKS_HISTOGRAM_SIZE - 1;
+    }
+    self->resimulatedTicksHistogram[bucket]++;
+    self->authoritativeUpdateCount++;
+}
+
+void seerStatsCallbackAdd(SeerStatsCallback* self, MonotonicTimeNanoseconds startedAt)
+{
+    self->totalTime += monotonicTimeNanosecondsNow() - startedAt;
+    self->callCount++;
+}
@@ -0,0 +1,145 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#if !defined _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <seer/thread.h>
+
+#if defined _WIN32
+
+static DWORD WINAPI seerThreadMain(LPVOID arg)
+{
+    SeerThread* self = (SeerThread*) arg;
+    self->fn(self->arg);
+    return 0;
+}
+
+int seerThreadCreate(SeerThread* self, SeerThreadFn fn, void* arg)
+{
+    self->fn = fn;
+    self->arg = arg;
+    self->handle = CreateThread(0, 0, seerThreadMain, self, 0, 0);
+    return self->handle == 0 ? -1 : 0;
+}
+
+void seerThreadJoin(SeerThread* self)
+{
+    WaitForSingleObject(self->handle, INFINITE);
+    CloseHandle(self->handle);
+}
+
+void seerMutexInit(SeerMutex* self)
+{
+    InitializeCriticalSection(&self->criticalSection);
+}
+
+void seerMutexDestroy(SeerMutex* self)
+{
+    DeleteCriticalSection(&self->criticalSection);
+}
+
+void seerMutexLock(SeerMutex* self)
+{
+    EnterCriticalSection(&self->criticalSection);
+}
+
+void seerMutexUnlock(SeerMutex* self)
+{
+    LeaveCriticalSection(&self->criticalSection);
+}
+
+void seerConditionInit(SeerCondition* self)
+{
+    InitializeConditionVariable(&self->condition);
+}
+
+void seerConditionDestroy(SeerCondition* self)
+{
+    (void) self;
+}
+
+void seerConditionWait(SeerCondition* self, SeerMutex* mutex)
+{
+    SleepConditionVariableCS(&self->condition, &mutex->criticalSection, INFINITE);
+}
+
+void seerConditionSignal(SeerCondition* self)
+{
+    WakeConditionVariable(&self->condition);
+}
+
+void seerConditionBroadcast(SeerCondition* self)
+{
+    WakeAllConditionVariable(&self->condition);
+}
+
+#else
+
+static void* seerThreadMain(void* arg)
+{
+    SeerThread* self = (SeerThread*) arg;
+    self->fn(self->arg);
+    return 0;
+}
+
+int seerThreadCreate(SeerThread* self, SeerThreadFn fn, void* arg)
+{
+    self->fn = fn;
+    self->arg = arg;
+    return pthread_create(&self->handle, 0, seerThreadMain, self) == 0 ? 0 : -1;
+}
+
+void seerThreadJoin(SeerThread* self)
+{
+    pthread_join(self->handle, 0);
+}
+
+void seerMutexInit(SeerMutex* self)
+{
+    pthread_mutex_init(&self->mutex, 0);
+}
+
+void seerMutexDestroy(SeerMutex* self)
+{
+    pthread_mutex_destroy(&self->mutex);
+}
+
+void seerMutexLock(SeerMutex* self)
+{
+    pthread_mutex_lock(&self->mutex);
+}
+
+void seerMutexUnlock(SeerMutex* self)
+{
+    pthread_mutex_unlock(&self->mutex);
+}
+
+void seerConditionInit(SeerCondition* self)
+{
+    pthread_cond_init(&self->condition, 0);
+}
+
+void seerConditionDestroy(SeerCondition* self)
+{
+    pthread_cond_destroy(&self->condition);
+}
+
+void seerConditionWait(SeerCondition* self, SeerMutex* mutex)
+{
+    pthread_cond_wait(&self->condition, &mutex->mutex);
+}
+
+void seerConditionSignal(SeerCondition* self)
+{
+    pthread_cond_signal(&self->condition);
+}
+
+void seerConditionBroadcast(SeerCondition* self)
+{
+    pthread_cond_broadcast(&self->condition);
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <imprint/allocator.h>
+#include <seer/trace.h>
+#include <stdio.h>
+
+void seerTraceInit(SeerTrace* self, struct ImprintAllocator* allocator, size_t capacity)
+{
+    self->capacity = capacity;
+    self->events = IMPRINT_ALLOC_TYPE_COUNT(allocator, SeerTraceEvent, capacity);
+    self->writeCount = 0;
+}
+
+void seerTraceClear(SeerTrace* self)
+{
+    self->writeCount = 0;
+}
+
+void seerTraceAdd(SeerTrace* self, SeerTraceEventType type, SeerTraceEventPhase phase, StepId stepId)
+{
+    SeerTraceEvent* event = &self->events[self->writeCount % self->capacity];
+    event->time = monotonicTimeNanosecondsNow();
+    event->stepId = stepId;
+    event->type = (uint8_t) type;
+    event->phase = (uint8_t) phase;
+    self->writeCount++;
+}
+
+static const char* seerTraceEventTypeToString(uint8_t type)
+{
+    switch ((SeerTraceEventType) type) {
+        case SeerTraceEventTypeUpdate:
+            return "update";
+        case SeerTraceEventTypeAuthoritativeArrived:
+            return "authoritativeArrived";
+        case SeerTraceEventTypeCopyFromAuthoritative:
+            return "copyFromAuthoritative";
+        case SeerTraceEventTypePredictionTick:
+            return "predictionTick";
+        case SeerTraceEventTypePredictionTicks:
+            return "predictionTicks";
+        case SeerTraceEventTypePostPredictionTicks:
+            return "postPredictionTicks";
+        case SeerTraceEventTypePredictedStateHash:
+            return "predictedStateHash";
+        case SeerTraceEventTypeAuthoritativeStateHash:
+            return "authoritativeStateHash";
+        case SeerTraceEventTypeSaveSnapshot:
+            return "saveSnapshot";
+        case SeerTraceEventTypeLoadSnapshot:
+            return "loadSnapshot";
+    }
+
+    return "unknown";
+}
+
+static char seerTraceEventPhaseToChar(uint8_t phase)
+{
+    switch ((SeerTraceEventPhase) phase) {
+        case SeerTraceEventPhaseBegin:
+            return 'B';
+        case SeerTraceEventPhaseEnd:
+            return 'E';
+        case SeerTraceEventPhaseInstant:
+            return 'i';
+    }
+
+    return 'i';
+}
+
+/// Writes the events, oldest first, as Chrome trace_event JSON (can be opened in chrome://tracing or Perfetto).
+/// Must not be called while Seer is adding events to the trace.
+/// @return number of written events, or negative on error
+int seerTraceDumpToFile(const SeerTrace* self, const char* filename)
+{
+    FILE* fp = fopen(filename, "w");
+    if (fp == 0) {
+        return -1;
+    }
+
+    size_t count = self->writeCount < self->capacity ? self->writeCount : self->capacity;
+    size_t firstIndex = self->writeCount - count;
+    MonotonicTimeNanoseconds startTime = count > 0 ? self->events[firstIndex % self->capacity].time : 0;
+
+    fprintf(fp, "{\"traceEvents\": [\n");
+    for (size_t i = 0; i < count; ++i) {
+        const SeerTraceEvent* event = &self->events[(firstIndex + i) % self->capacity];
+        fprintf(fp,
+                "%s  {\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": 1%s, "
+                "\"args\": {\"stepId\": %u}}",
+                i == 0 ? "" : ",\n", seerTraceEventTypeToString(event->type), seerTraceEventPhaseToChar(event->phase),
+                (double) (event->time - startTime) / 1000.0,
+                event->phase == SeerTraceEventPhaseInstant ? ", \"s\": \"t\"" : "", (unsigned) event->stepId);
+    }
+    fprintf(fp, "\n]}\n");
+
+    if (fclose(fp) != 0) {
+        return -2;
+    }
+
+    return (int) count;
+}
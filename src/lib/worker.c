@@ -0,0 +1,181 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <imprint/allocator.h>
+#include <seer/worker.h>
+
+/// The Seer must have saveSnapshotFn set, it is used to copy the predicted state for presentation, and it must
+/// be initialized with maxEnqueuedSteps.
+/// allocatorWithFree is optional. If it is set, it is used instead of allocator and the presentation buffers are
+/// freed in seerWorkerDestroy().
+void seerWorkerInit(SeerWorker* self, Seer* seer, struct ImprintAllocator* allocator,
+                    struct ImprintAllocatorWithFree* allocatorWithFree, size_t maxPresentationOctetCount, Clog log)
+{
+    CLOG_ASSERT(seer->callbackObject.vtbl->saveSnapshotFn != 0, "saveSnapshotFn is needed for the presentation state")
+    CLOG_ASSERT(seer->enqueuedSteps.capacity > 0, "seer must be initialized with maxEnqueuedSteps")
+
+    self->seer = seer;
+    self->log = log;
+    self->updateRequested = false;
+    self->stopRequested = false;
+    self->isRunning = false;
+    self->allocatorWithFree = allocatorWithFree;
+    if (allocatorWithFree != 0) {
+        allocator = &allocatorWithFree->allocator;
+    }
+
+    self->maxPresentationOctetCount = maxPresentationOctetCount;
+    for (size_t i = 0; i < 3; ++i) {
+        self->presentationBuffers[i].octets = IMPRINT_ALLOC_TYPE_COUNT(allocator, uint8_t, maxPresentationOctetCount);
+        self->presentationBuffers[i].octetCount = 0;
+        self->presentationBuffers[i].stepId = 0;
+    }
+    self->writeIndex = 0;
+    self->readyIndex = 1;
+    self->readIndex = 2;
+    self->hasNewPresentation = false;
+    self->hasPresentation = false;
+
+    seerMutexInit(&self->mutex);
+    seerConditionInit(&self->wakeUp);
+}
+
+void seerWorkerDestroy(SeerWorker* self)
+{
+    seerWorkerStop(self);
+    seerConditionDestroy(&self->wakeUp);
+    seerMutexDestroy(&self->mutex);
+
+    if (self->allocatorWithFree == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        IMPRINT_FREE(self->allocatorWithFree, self->presentationBuffers[i].octets);
+        self->presentationBuffers[i].octets = 0;
+    }
+    self->allocatorWithFree = 0;
+}
+
+/// Copies the predicted state into the write buffer and swaps it with the ready buffer
+static void seerWorkerPublish(SeerWorker* self)
+{
+    SeerWorkerPresentationBuffer* buffer = &self->presentationBuffers[self->writeIndex];
+    const SeerCallbackObject* callbackObject = &self->seer->callbackObject;
+
+    int octetCount = callbackObject->vtbl->saveSnapshotFn(callbackObject->self, buffer->octets,
+                                                          self->maxPresentationOctetCount, self->seer->stepId);
+    if (octetCount < 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "could not save presentation state")
+        return;
+    }
+
+    buffer->octetCount = (size_t) octetCount;
+    buffer->stepId = self->seer->stepId;
+
+    seerMutexLock(&self->mutex);
+    size_t readyIndex = self->readyIndex;
+    self->readyIndex = self->writeIndex;
+    self->writeIndex = readyIndex;
+    self->hasNewPresentation = true;
+    seerMutexUnlock(&self->mutex);
+}
+
+static void seerWorkerRun(void* arg)
+{
+    SeerWorker* self = (SeerWorker*) arg;
+
+    while (true) {
+        seerMutexLock(&self->mutex);
+        while (!self->updateRequested && !self->stopRequested) {
+            seerConditionWait(&self->wakeUp, &self->mutex);
+        }
+
+        if (self->stopRequested) {
+            seerMutexUnlock(&self->mutex);
+            break;
+        }
+
+        self->updateRequested = false;
+        seerMutexUnlock(&self->mutex);
+
+        seerUpdate(self->seer);
+        seerWorkerPublish(self);
+    }
+}
+
+int seerWorkerStart(SeerWorker* self)
+{
+    self->stopRequested = false;
+    int result = seerThreadCreate(&self->thread, seerWorkerRun, self);
+    if (result < 0) {
+        CLOG_C_SOFT_ERROR(&self->log, "could not start worker thread")
+        return result;
+    }
+    self->isRunning = true;
+
+    return 0;
+}
+
+void seerWorkerStop(SeerWorker* self)
+{
+    if (!self->isRunning) {
+        return;
+    }
+
+    seerMutexLock(&self->mutex);
+    self->stopRequested = true;
+    seerConditionSignal(&self->wakeUp);
+    seerMutexUnlock(&self->mutex);
+
+    seerThreadJoin(&self->thread);
+    self->isRunning = false;
+}
+
+/// Wakes up the worker thread to apply the enqueued steps and predict. Usually called once every frame.
+void seerWorkerRequestUpdate(SeerWorker* self)
+{
+    seerMutexLock(&self->mutex);
+    self->updateRequested = true;
+    seerConditionSignal(&self->wakeUp);
+    seerMutexUnlock(&self->mutex);
+}
+
+/// Must always be called from the same thread.
+int seerWorkerAddPredictedStepRaw(SeerWorker* self, const uint8_t* combinedStep, size_t octetCount, StepId tickId)
+{
+    return seerEnqueuePredictedStepRaw(self->seer, combinedStep, octetCount, tickId);
+}
+
+/// Must always be called from the same thread.
+int seerWorkerAuthoritativeGotNewState(SeerWorker* self, StepId stepId)
+{
+    return seerEnqueueAuthoritativeGotNewState(self->seer, stepId);
+}
+
+/// Gets the most recently completed predicted state.
+/// The returned octets are valid until the next call to seerWorkerReadPredictedState().
+/// @return the predicted state octets, or NULL if no prediction has been completed yet
+const uint8_t* seerWorkerReadPredictedState(SeerWorker* self, size_t* octetCount, StepId* stepId)
+{
+    seerMutexLock(&self->mutex);
+    if (self->hasNewPresentation) {
+        size_t readIndex = self->readIndex;
+        self->readIndex = self->readyIndex;
+        self->readyIndex = readIndex;
+        self->hasNewPresentation = false;
+        self->hasPresentation = true;
+    }
+    seerMutexUnlock(&self->mutex);
+
+    if (!self->hasPresentation) {
+        return 0;
+    }
+
+    const SeerWorkerPresentationBuffer* buffer = &self->presentationBuffers[self->readIndex];
+    *octetCount = buffer->octetCount;
+    *stepId = buffer->stepId;
+
+    return buffer->octets;
+}
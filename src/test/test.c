@@ -8,7 +8,9 @@
 #include <nimble-steps-serialize/in_serialize.h>
 #include <nimble-steps-serialize/out_serialize.h>
 #include <nimble-steps/steps.h>
+#include <seer/scheduler.h>
 #include <seer/seer.h>
+#include <seer/worker.h>
 
 typedef struct AppSpecificState {
     int x;
@@ -23,9 +25,17 @@ typedef struct AppSpecificVm {
     AppSpecificState appSpecificState;
 } AppSpecificVm;
 
+#define APP_SPECIFIC_MAX_BRANCH_COUNT (4)
+
 typedef struct AppSpecificCallback {
     TransmuteVm* transmuteVm;
+    AppSpecificVm branchVms[APP_SPECIFIC_MAX_BRANCH_COUNT];
+    int selectedBranchIndex;
     TransmuteState* mockAuthoritativeState;
+    int copyFromAuthoritativeCount;
+    int predictTickCount;
+    int predictTicksCallCount;
+    const void* lastPredictedPayload;
 } AppSpecificCallback;
 
 void appSpecificTick(void* _self, const TransmuteInput* input)
@@ -87,6 +97,7 @@ void appSpecificSeerCopyFromAuthoritative(void* _self, StepId stepId)
 {
     AppSpecificCallback* self = (AppSpecificCallback*) _self;
     CLOG_INFO("prediction: copy from authoritative %u", stepId)
+    self->copyFromAuthoritativeCount++;
     transmuteVmSetState(self->transmuteVm, self->mockAuthoritativeState);
 }
 
@@ -94,9 +105,22 @@ void appSpecificSeerPredictTick(void* _self, const TransmuteInput* input, StepId
 {
     AppSpecificCallback* self = (AppSpecificCallback*) _self;
     CLOG_INFO("prediction: tick()")
+    self->predictTickCount++;
+    self->lastPredictedPayload = input->participantCount > 0 ? input->participantInputs[0].input : 0;
     transmuteVmTick(self->transmuteVm, input);
 }
 
+void appSpecificSeerPredictTicks(void* _self, const TransmuteInput* inputs, size_t count, StepId firstStepId)
+{
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    CLOG_INFO("prediction: ticks() %u count: %zu", firstStepId, count)
+    self->predictTicksCallCount++;
+    for (size_t i = 0; i < count; ++i) {
+        self->predictTickCount++;
+        transmuteVmTick(self->transmuteVm, &inputs[i]);
+    }
+}
+
 void appSpecificSeerPostTicks(void* _self)
 {
     AppSpecificCallback* self = (AppSpecificCallback*) _self;
@@ -140,6 +164,8 @@ UTEST(Assent, verify)
 
     appSpecificCallback.transmuteVm = &transmuteVm;
     appSpecificCallback.mockAuthoritativeState = &initialTransmuteState;
+    appSpecificCallback.copyFromAuthoritativeCount = 0;
+    appSpecificCallback.predictTickCount = 0;
 
     StepId initialStepId = {101};
 
@@ -148,6 +174,7 @@ UTEST(Assent, verify)
     predictSubLog.config = &g_clog;
 
     SeerSetup seerSetup;
+    seerSetupInit(&seerSetup);
     seerSetup.allocator = &imprint.slabAllocator.info.allocator;
     seerSetup.maxTicksFromAuthoritative = 10;
     seerSetup.maxPlayers = 16;
@@ -196,3 +223,1129 @@ UTEST(Assent, verify)
     ASSERT_EQ(1, currentAppState->x);
     ASSERT_EQ(1, currentAppState->time);
 }
+
+static int appSpecificSeerSaveSnapshot(void* _self, uint8_t* target, size_t maxOctetCount, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    TransmuteState state = transmuteVmGetState(self->transmuteVm);
+    if (state.octetSize > maxOctetCount) {
+        return -1;
+    }
+    tc_memcpy_octets(target, state.state, state.octetSize);
+    return (int) state.octetSize;
+}
+
+static void appSpecificSeerLoadSnapshot(void* _self, const uint8_t* source, size_t octetCount, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    TransmuteState state;
+    state.state = source;
+    state.octetSize = octetCount;
+    transmuteVmSetState(self->transmuteVm, &state);
+}
+
+static void appSpecificSeerBranchCopyFromAuthoritative(void* _self, size_t branchIndex, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    self->branchVms[branchIndex].appSpecificState = *(const AppSpecificState*) self->mockAuthoritativeState->state;
+}
+
+static void appSpecificSeerBranchTick(void* _self, size_t branchIndex, const TransmuteInput* input, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    appSpecificTick(&self->branchVms[branchIndex], input);
+}
+
+static void appSpecificSeerSelectBranch(void* _self, size_t branchIndex, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    self->selectedBranchIndex = (int) branchIndex;
+    TransmuteState state = appSpecificGetState(&self->branchVms[branchIndex]);
+    transmuteVmSetState(self->transmuteVm, &state);
+}
+
+typedef struct TestFixture {
+    ImprintDefaultSetup imprint;
+    Seer seer;
+    AppSpecificVm appSpecificVm;
+    TransmuteVm transmuteVm;
+    AppSpecificCallback appSpecificCallback;
+    AppSpecificState authoritativeAppState;
+    TransmuteState authoritativeTransmuteState;
+    SeerCallbackObjectVtbl vtbl;
+} TestFixture;
+
+/// Only the optional fields of options are used, the rest of the setup is the same for all tests
+static void testFixtureInitWithSetup(TestFixture* self, StepId initialStepId, const SeerSetup* options)
+{
+    imprintDefaultSetupInit(&self->imprint, 16 * 1024 * 1024);
+
+    TransmuteVmSetup setup;
+    setup.tickFn = appSpecificTick;
+    setup.tickDurationMs = 16;
+    setup.setStateFn = appSpecificSetState;
+    setup.getStateFn = appSpecificGetState;
+    setup.inputToString = appSpecificInputToString;
+    setup.stateToString = appSpecificStateToString;
+
+    Clog subLog;
+    subLog.config = &g_clog;
+    subLog.constantPrefix = "AuthoritativeVm";
+
+    transmuteVmInit(&self->transmuteVm, &self->appSpecificVm, setup, subLog);
+
+    self->authoritativeAppState.time = 0;
+    self->authoritativeAppState.x = 0;
+    self->authoritativeTransmuteState.state = &self->authoritativeAppState;
+    self->authoritativeTransmuteState.octetSize = sizeof(self->authoritativeAppState);
+
+    self->appSpecificCallback.transmuteVm = &self->transmuteVm;
+    self->appSpecificCallback.mockAuthoritativeState = &self->authoritativeTransmuteState;
+    self->appSpecificCallback.copyFromAuthoritativeCount = 0;
+    self->appSpecificCallback.predictTickCount = 0;
+    self->appSpecificCallback.predictTicksCallCount = 0;
+    self->appSpecificCallback.lastPredictedPayload = 0;
+    self->appSpecificCallback.selectedBranchIndex = -1;
+
+    Clog predictSubLog;
+    predictSubLog.constantPrefix = "seer";
+    predictSubLog.config = &g_clog;
+
+    SeerSetup seerSetup;
+    seerSetupInit(&seerSetup);
+    seerSetup.allocatorWithFree = &self->imprint.slabAllocator.info;
+    seerSetup.maxTicksFromAuthoritative = 10;
+    seerSetup.maxPlayers = 16;
+    seerSetup.maxStepOctetSizeForSingleParticipant = 12;
+    seerSetup.checkpointInterval = options->checkpointInterval;
+    seerSetup.maxCheckpointOctetSize = sizeof(AppSpecificState);
+    seerSetup.maxEnqueuedSteps = options->maxEnqueuedSteps;
+    seerSetup.payloadAlignment = options->payloadAlignment;
+    seerSetup.maxSpeculativeBranchCount = options->maxSpeculativeBranchCount;
+    seerSetup.useParticipantInputsSoa = options->useParticipantInputsSoa;
+    seerSetup.log = predictSubLog;
+
+    SeerCallbackObjectVtbl vtbl = {
+        .predictionTickFn = appSpecificSeerPredictTick,
+        .copyFromAuthoritativeFn = appSpecificSeerCopyFromAuthoritative,
+        .postPredictionTicksFn = appSpecificSeerPostTicks,
+        .saveSnapshotFn = appSpecificSeerSaveSnapshot,
+        .loadSnapshotFn = appSpecificSeerLoadSnapshot,
+        .branchCopyFromAuthoritativeFn = appSpecificSeerBranchCopyFromAuthoritative,
+        .branchTickFn = appSpecificSeerBranchTick,
+        .selectBranchFn = appSpecificSeerSelectBranch,
+    };
+    self->vtbl = vtbl;
+
+    SeerCallbackObject callbackObject = {.vtbl = &self->vtbl, .self = &self->appSpecificCallback};
+
+    seerInit(&self->seer, callbackObject, seerSetup, initialStepId);
+}
+
+static void testFixtureInitWithAlignment(TestFixture* self, StepId initialStepId, size_t checkpointInterval,
+                                         size_t payloadAlignment)
+{
+    SeerSetup options;
+    seerSetupInit(&options);
+    options.checkpointInterval = checkpointInterval;
+    options.payloadAlignment = payloadAlignment;
+    testFixtureInitWithSetup(self, initialStepId, &options);
+}
+
+static void testFixtureInitWithCheckpoints(TestFixture* self, StepId initialStepId, size_t checkpointInterval)
+{
+    testFixtureInitWithAlignment(self, initialStepId, checkpointInterval, 0);
+}
+
+static void testFixtureInitWithEnqueuedSteps(TestFixture* self, StepId initialStepId, size_t maxEnqueuedSteps)
+{
+    SeerSetup options;
+    seerSetupInit(&options);
+    options.maxEnqueuedSteps = maxEnqueuedSteps;
+    testFixtureInitWithSetup(self, initialStepId, &options);
+}
+
+static void testFixtureInitWithSpeculation(TestFixture* self, StepId initialStepId, size_t maxSpeculativeBranchCount)
+{
+    SeerSetup options;
+    seerSetupInit(&options);
+    options.maxSpeculativeBranchCount = maxSpeculativeBranchCount;
+    testFixtureInitWithSetup(self, initialStepId, &options);
+}
+
+static void testFixtureInitWithSoa(TestFixture* self, StepId initialStepId)
+{
+    SeerSetup options;
+    seerSetupInit(&options);
+    options.useParticipantInputsSoa = true;
+    testFixtureInitWithSetup(self, initialStepId, &options);
+}
+
+static void testFixtureInit(TestFixture* self, StepId initialStepId)
+{
+    testFixtureInitWithCheckpoints(self, initialStepId, 0);
+}
+
+static void testFixtureDestroy(TestFixture* self)
+{
+    seerDestroy(&self->seer);
+}
+
+static uint64_t appSpecificHashState(const AppSpecificState* state)
+{
+    return ((uint64_t) (uint32_t) state->time << 32) | (uint32_t) state->x;
+}
+
+static uint64_t appSpecificSeerPredictedStateHash(void* _self, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    TransmuteState state = transmuteVmGetState(self->transmuteVm);
+    return appSpecificHashState((const AppSpecificState*) state.state);
+}
+
+static uint64_t appSpecificSeerAuthoritativeStateHash(void* _self, StepId stepId)
+{
+    (void) stepId;
+    AppSpecificCallback* self = (AppSpecificCallback*) _self;
+    return appSpecificHashState((const AppSpecificState*) self->mockAuthoritativeState->state);
+}
+
+static size_t testFixtureSerializeStep(int horizontalAxis, uint8_t* target, size_t maxOctetCount)
+{
+    AppSpecificParticipantInput gameInput;
+    gameInput.horizontalAxis = horizontalAxis;
+
+    NimbleStepsOutSerializeLocalParticipants data;
+    data.participants[0].participantId = 1;
+    data.participants[0].localPartyId = 0;
+    data.participants[0].stepType = NimbleSerializeStepTypeNormal;
+    data.participants[0].payload = (const uint8_t*) &gameInput;
+    data.participants[0].payloadCount = sizeof(gameInput);
+    data.participantCount = 1;
+
+    return (size_t) nbsStepsOutSerializeCombinedStep(&data, target, maxOctetCount);
+}
+
+static void testFixtureAddPredictedStep(TestFixture* self, int horizontalAxis, StepId stepId)
+{
+    uint8_t buf[64];
+    size_t octetCount = testFixtureSerializeStep(horizontalAxis, buf, sizeof(buf));
+    seerAddPredictedStepRaw(&self->seer, buf, octetCount, stepId);
+}
+
+static int testFixtureConfirmStep(TestFixture* self, int horizontalAxis, StepId stepId)
+{
+    uint8_t buf[64];
+    size_t octetCount = testFixtureSerializeStep(horizontalAxis, buf, sizeof(buf));
+    return seerConfirmStepRaw(&self->seer, buf, octetCount, stepId);
+}
+
+UTEST(Assent, confirmedStepsSkipRollback)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+
+    ASSERT_EQ(1, testFixtureConfirmStep(&fixture, 1, initialStepId));
+    ASSERT_EQ(1, testFixtureConfirmStep(&fixture, 1, initialStepId + 1));
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 2);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(initialStepId + 4, fixture.seer.stepId);
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+
+    ASSERT_EQ(0, testFixtureConfirmStep(&fixture, 0, initialStepId + 2));
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 3);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(2, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(5, fixture.appSpecificCallback.predictTickCount);
+
+    // The fixture is set up without maxSpeculativeBranchCount, so confirming does not involve any branches
+    AppSpecificParticipantInput hypothesisInput;
+    hypothesisInput.horizontalAxis = 0;
+    SeerPayloadFragment hypothesis;
+    hypothesis.octets = &hypothesisInput;
+    hypothesis.octetCount = sizeof(hypothesisInput);
+    ASSERT_TRUE(seerSetSpeculation(&fixture.seer, 1, &hypothesis, 1) < 0);
+    ASSERT_EQ(0, seerUpdateSpeculativeBranches(&fixture.seer));
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, matchingStateHashSkipsRollback)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+    fixture.vtbl.predictedStateHashFn = appSpecificSeerPredictedStateHash;
+    fixture.vtbl.authoritativeStateHashFn = appSpecificSeerAuthoritativeStateHash;
+
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+
+    fixture.authoritativeAppState.time = 2;
+    fixture.authoritativeAppState.x = 2;
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 2);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(initialStepId + 4, fixture.seer.stepId);
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+
+    fixture.authoritativeAppState.time = 3;
+    fixture.authoritativeAppState.x = 2;
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 3);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(2, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(5, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(initialStepId + 4, fixture.seer.stepId);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, stateHashesAreForgottenOnRollback)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+    fixture.vtbl.predictedStateHashFn = appSpecificSeerPredictedStateHash;
+    fixture.vtbl.authoritativeStateHashFn = appSpecificSeerAuthoritativeStateHash;
+
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+
+    // The correction rolls back, and the ticks are predicted again in one batch, so only the hash after the batch is
+    // recorded
+    fixture.vtbl.predictionTicksFn = appSpecificSeerPredictTicks;
+    testFixtureAddPredictedStep(&fixture, 0, initialStepId);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(2, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(1, fixture.appSpecificCallback.predictTicksCallCount);
+    ASSERT_EQ(3, fixture.appSpecificVm.appSpecificState.x);
+
+    // The authoritative state is the one from the prediction that was thrown away, so it must be copied
+    fixture.authoritativeAppState.time = 2;
+    fixture.authoritativeAppState.x = 2;
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 2);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(3, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(4, fixture.appSpecificVm.appSpecificState.x);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, updateWithBudgetResumes)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(2, seerUpdateWithBudget(&fixture.seer, 0));
+    ASSERT_EQ(1, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(initialStepId + 1, fixture.seer.stepId);
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(4, fixture.appSpecificVm.appSpecificState.x);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, statsCountsPredictionWork)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerStats stats;
+    seerStatsInit(&stats);
+    seerSetStats(&fixture.seer, &stats);
+
+    for (StepId i = 0; i < 3; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 1);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(5U, stats.predictedTickCount);
+    ASSERT_EQ(5U, stats.predictionTick.callCount);
+    ASSERT_EQ(1U, stats.copyFromAuthoritative.callCount);
+    ASSERT_EQ(1U, stats.authoritativeUpdateCount);
+    ASSERT_EQ(1U, stats.resimulatedTicksHistogram[2]);
+    ASSERT_EQ(2U, stats.missingInputStopCount);
+    ASSERT_EQ(0U, stats.horizonCapHitCount);
+    ASSERT_EQ(3U * sizeof(AppSpecificParticipantInput), stats.storedPayloadOctetCount);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, lateCorrectionRestoresNearestCheckpoint)
+{
+    TestFixture fixture;
+    StepId initialStepId = 100;
+    testFixtureInitWithCheckpoints(&fixture, initialStepId, 2);
+
+    for (StepId i = 0; i < 6; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(6, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(6, fixture.appSpecificVm.appSpecificState.x);
+
+    testFixtureAddPredictedStep(&fixture, 0, initialStepId + 5);
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(8, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(5, fixture.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(6, fixture.appSpecificVm.appSpecificState.time);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, workerPublishesPredictedState)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInitWithEnqueuedSteps(&fixture, initialStepId, 8);
+
+    SeerWorker worker;
+    seerWorkerInit(&worker, &fixture.seer, &fixture.imprint.slabAllocator.info.allocator,
+                   &fixture.imprint.slabAllocator.info, sizeof(AppSpecificState), fixture.seer.log);
+    ASSERT_EQ(0, seerWorkerStart(&worker));
+
+    size_t octetCount = 0;
+    StepId predictedStepId = 0;
+    ASSERT_TRUE(seerWorkerReadPredictedState(&worker, &octetCount, &predictedStepId) == 0);
+
+    for (StepId i = 0; i < 3; ++i) {
+        uint8_t buf[64];
+        size_t stepOctetCount = testFixtureSerializeStep(1, buf, sizeof(buf));
+        ASSERT_EQ(0, seerWorkerAddPredictedStepRaw(&worker, buf, stepOctetCount, initialStepId + i));
+    }
+    seerWorkerRequestUpdate(&worker);
+
+    const uint8_t* predictedState = 0;
+    while (predictedState == 0) {
+        predictedState = seerWorkerReadPredictedState(&worker, &octetCount, &predictedStepId);
+    }
+
+    const AppSpecificState* appState = (const AppSpecificState*) predictedState;
+    ASSERT_EQ(sizeof(AppSpecificState), octetCount);
+    ASSERT_EQ(initialStepId + 3, predictedStepId);
+    ASSERT_EQ(3, appState->x);
+
+    seerWorkerDestroy(&worker);
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, authoritativeStatesAreCoalesced)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerStats stats;
+    seerStatsInit(&stats);
+    seerSetStats(&fixture.seer, &stats);
+
+    for (StepId i = 0; i < 5; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 1);
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 3);
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 2);
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(2, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(initialStepId + 3, fixture.seer.authoritativeStepId);
+    ASSERT_EQ(1U, stats.coalescedAuthoritativeCount);
+    ASSERT_EQ(7, fixture.appSpecificCallback.predictTickCount);
+
+    // The fixture is set up without maxEnqueuedSteps, so the thread safe versions can not be used
+    ASSERT_TRUE(seerEnqueueAuthoritativeGotNewState(&fixture.seer, initialStepId + 4) < 0);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, inputPredictorReachesHorizon)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerInputPredictorSetup predictorSetup;
+    predictorSetup.mode = SeerInputPredictorModeDecayToNeutral;
+    predictorSetup.ticksUntilNeutral = 2;
+    predictorSetup.predictParticipantInputFn = 0;
+    predictorSetup.predictParticipantInputSelf = 0;
+    seerSetInputPredictor(&fixture.seer, predictorSetup);
+
+    testFixtureAddPredictedStep(&fixture, 1, initialStepId);
+    ASSERT_EQ(1, testFixtureConfirmStep(&fixture, 1, initialStepId));
+
+    ASSERT_EQ(1, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(10, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(3, fixture.appSpecificVm.appSpecificState.x);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, inputPredictorContinuesAfterJoin)
+{
+    ImprintDefaultSetup imprint;
+    imprintDefaultSetupInit(&imprint, 1024 * 1024);
+
+    SeerInputPredictor inputPredictor;
+    seerInputPredictorInit(&inputPredictor, &imprint.slabAllocator.info.allocator, 4, 8, 0);
+
+    SeerInputPredictorSetup predictorSetup;
+    predictorSetup.mode = SeerInputPredictorModeRepeatLast;
+    predictorSetup.ticksUntilNeutral = 0;
+    predictorSetup.predictParticipantInputFn = 0;
+    predictorSetup.predictParticipantInputSelf = 0;
+    seerInputPredictorSet(&inputPredictor, predictorSetup);
+
+    AppSpecificParticipantInput gameInput;
+    gameInput.horizontalAxis = 1;
+    TransmuteParticipantInput participantInputs[2];
+    participantInputs[0].participantId = 1;
+    participantInputs[0].localPartyId = 0;
+    participantInputs[0].inputType = TransmuteParticipantInputTypeJoined;
+    participantInputs[0].input = &gameInput;
+    participantInputs[0].octetSize = sizeof(gameInput);
+    participantInputs[1].participantId = 2;
+    participantInputs[1].localPartyId = 0;
+    participantInputs[1].inputType = TransmuteParticipantInputTypeWaitingForReJoin;
+    participantInputs[1].input = 0;
+    participantInputs[1].octetSize = 0;
+    TransmuteInput confirmed;
+    confirmed.participantInputs = participantInputs;
+    confirmed.participantCount = 2;
+
+    StepId confirmedStepId = 101;
+    seerInputPredictorConfirmed(&inputPredictor, &confirmed, confirmedStepId);
+
+    // The join is not repeated, the participant that joined is predicted to keep sending its input
+    for (StepId i = 1; i < 3; ++i) {
+        size_t synthesizedCount;
+        const TransmuteInput* predicted = seerInputPredictorPredict(&inputPredictor, 0, confirmedStepId + i,
+                                                                    &synthesizedCount);
+        ASSERT_EQ(2U, synthesizedCount);
+        ASSERT_EQ(TransmuteParticipantInputTypeNormal, predicted->participantInputs[0].inputType);
+        ASSERT_EQ(sizeof(gameInput), predicted->participantInputs[0].octetSize);
+        ASSERT_EQ(0, tc_memcmp(predicted->participantInputs[0].input, &gameInput, sizeof(gameInput)));
+        ASSERT_EQ(TransmuteParticipantInputTypeWaitingForReJoin, predicted->participantInputs[1].inputType);
+    }
+
+    seerInputPredictorDestroy(&inputPredictor, &imprint.slabAllocator.info);
+}
+
+UTEST(Assent, predictionTicksAreBatched)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInitWithCheckpoints(&fixture, initialStepId, 4);
+    fixture.vtbl.predictionTicksFn = appSpecificSeerPredictTicks;
+
+    for (StepId i = 0; i < 8; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    // 101..103, then a checkpoint at 104 and 104..107
+    ASSERT_EQ(2, fixture.appSpecificCallback.predictTicksCallCount);
+    ASSERT_EQ(8, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(8, fixture.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(initialStepId + 8, fixture.seer.stepId);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, resetReusesBuffers)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInitWithCheckpoints(&fixture, initialStepId, 4);
+
+    for (StepId i = 0; i < 6; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(6, fixture.appSpecificVm.appSpecificState.x);
+
+    const TransmuteInput* inputs = fixture.seer.predictedSteps.inputs;
+    StepId resetStepId = 2000;
+    seerReset(&fixture.seer, resetStepId);
+
+    ASSERT_EQ(2, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(0, fixture.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(resetStepId, fixture.seer.stepId);
+    ASSERT_EQ(0U, fixture.seer.predictedSteps.stepsCount);
+    ASSERT_TRUE(inputs == fixture.seer.predictedSteps.inputs);
+
+    testFixtureAddPredictedStep(&fixture, 1, resetStepId);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(1, fixture.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(resetStepId + 1, fixture.seer.stepId);
+
+    seerDestroy(&fixture.seer);
+    ASSERT_TRUE(fixture.seer.predictedSteps.inputs == 0);
+    ASSERT_TRUE(fixture.seer.cachedTransmuteInput.participantInputs == 0);
+    ASSERT_TRUE(fixture.seer.predictedStateHashes == 0);
+    ASSERT_TRUE(fixture.seer.allocatorWithFree == 0);
+}
+
+#if defined SEER_TRACE
+UTEST(Assent, traceRecordsUpdateAndCallbacks)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerTrace trace;
+    seerTraceInit(&trace, &fixture.imprint.slabAllocator.info.allocator, 64);
+    seerSetTrace(&fixture.seer, &trace);
+
+    testFixtureAddPredictedStep(&fixture, 1, initialStepId);
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 1);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    // authoritative arrived, then update, copy and post ticks begin and end
+    ASSERT_EQ(7U, trace.writeCount);
+    ASSERT_EQ(SeerTraceEventTypeAuthoritativeArrived, trace.events[0].type);
+    ASSERT_EQ(SeerTraceEventTypeUpdate, trace.events[1].type);
+    ASSERT_EQ(SeerTraceEventPhaseBegin, trace.events[1].phase);
+    ASSERT_EQ(SeerTraceEventTypeCopyFromAuthoritative, trace.events[2].type);
+    ASSERT_EQ(SeerTraceEventTypeUpdate, trace.events[6].type);
+    ASSERT_EQ(SeerTraceEventPhaseEnd, trace.events[6].phase);
+
+    ASSERT_EQ(7, seerTraceDumpToFile(&trace, "seer_trace.json"));
+    remove("seer_trace.json");
+
+    testFixtureDestroy(&fixture);
+}
+#endif
+
+static int testFixtureSaveAuthoritative(void* _self, uint8_t* target, size_t maxOctetCount, StepId stepId)
+{
+    (void) stepId;
+    const TestFixture* self = (const TestFixture*) _self;
+    if (maxOctetCount < sizeof(self->authoritativeAppState)) {
+        return -1;
+    }
+    tc_memcpy_octets(target, &self->authoritativeAppState, sizeof(self->authoritativeAppState));
+    return (int) sizeof(self->authoritativeAppState);
+}
+
+static void testFixtureLoadAuthoritative(void* _self, const uint8_t* source, size_t octetCount, StepId stepId)
+{
+    (void) stepId;
+    TestFixture* self = (TestFixture*) _self;
+    tc_memcpy_octets(&self->authoritativeAppState, source, octetCount);
+}
+
+UTEST(Assent, captureIsPlayedBack)
+{
+    static TestFixture recorded;
+    StepId initialStepId = 101;
+    testFixtureInit(&recorded, initialStepId);
+
+    static uint8_t captureOctets[4096];
+    SeerRecorder recorder;
+    seerRecorderInit(&recorder, captureOctets, sizeof(captureOctets), testFixtureSaveAuthoritative, &recorded);
+    seerSetRecorder(&recorded.seer, &recorder);
+
+    StepId recordedStepIds[10];
+    int recordedUpdateCount = 0;
+    for (StepId i = 0; i < 6; ++i) {
+        testFixtureAddPredictedStep(&recorded, (int) (i % 2), initialStepId + i);
+        seerUpdate(&recorded.seer);
+        recordedStepIds[recordedUpdateCount++] = recorded.seer.stepId;
+    }
+    recorded.authoritativeAppState.x = 10;
+    recorded.authoritativeAppState.time = 3;
+    seerAuthoritativeGotNewState(&recorded.seer, initialStepId + 3);
+    seerUpdate(&recorded.seer);
+    recordedStepIds[recordedUpdateCount++] = recorded.seer.stepId;
+
+    // The decoded and gathered add paths are recorded too, and an update that runs out of its time budget is played
+    // back up to the same step
+    AppSpecificParticipantInput gameInput;
+    gameInput.horizontalAxis = -1;
+    SeerPayloadFragment fragment;
+    fragment.octets = &gameInput;
+    fragment.octetCount = sizeof(gameInput);
+    SeerGatherParticipant gatherParticipant;
+    gatherParticipant.participantId = 1;
+    gatherParticipant.localPartyId = 0;
+    gatherParticipant.inputType = TransmuteParticipantInputTypeNormal;
+    gatherParticipant.fragments = &fragment;
+    gatherParticipant.fragmentCount = 1;
+    ASSERT_EQ(0, seerAddPredictedStepGather(&recorded.seer, &gatherParticipant, 1, initialStepId + 6));
+
+    TransmuteParticipantInput participantInput;
+    participantInput.participantId = 1;
+    participantInput.localPartyId = 0;
+    participantInput.inputType = TransmuteParticipantInputTypeNormal;
+    participantInput.input = &gameInput;
+    participantInput.octetSize = sizeof(gameInput);
+    TransmuteInput input;
+    input.participantInputs = &participantInput;
+    input.participantCount = 1;
+    ASSERT_EQ(0, seerAddPredictedStep(&recorded.seer, &input, initialStepId + 7));
+    testFixtureAddPredictedStep(&recorded, 1, initialStepId + 8);
+
+    ASSERT_EQ(2, seerUpdateWithBudget(&recorded.seer, 0));
+    recordedStepIds[recordedUpdateCount++] = recorded.seer.stepId;
+    seerUpdate(&recorded.seer);
+    recordedStepIds[recordedUpdateCount++] = recorded.seer.stepId;
+    ASSERT_EQ(0U, recorder.droppedRecordCount);
+
+    static TestFixture played;
+    testFixtureInit(&played, initialStepId);
+
+    SeerPlayer player;
+    ASSERT_EQ(0, seerPlayerInit(&player, captureOctets, recorder.octetCount, testFixtureLoadAuthoritative, &played));
+    int updateCount = 0;
+    while (seerPlayerUpdate(&player, &played.seer) == 1) {
+        ASSERT_EQ(recordedStepIds[updateCount], played.seer.stepId);
+        updateCount++;
+    }
+
+    ASSERT_EQ(recordedUpdateCount, updateCount);
+    ASSERT_EQ(recorded.seer.stepId, played.seer.stepId);
+    ASSERT_EQ(recorded.appSpecificCallback.predictTickCount, played.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(recorded.appSpecificVm.appSpecificState.x, played.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(recorded.appSpecificVm.appSpecificState.time, played.appSpecificVm.appSpecificState.time);
+
+    testFixtureDestroy(&recorded);
+    testFixtureDestroy(&played);
+}
+
+UTEST(Assent, adaptiveHorizonFollowsLatency)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerAdaptiveHorizonSetup horizonSetup;
+    horizonSetup.minTicks = 2;
+    horizonSetup.maxTicks = 20;
+    horizonSetup.marginTicks = 1;
+    horizonSetup.maxPredictionTimePerUpdate = 0;
+    seerSetAdaptiveHorizon(&fixture.seer, horizonSetup);
+    ASSERT_EQ(10U, fixture.seer.adaptiveHorizon.horizonTicks);
+
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 1);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    // the predicted steps were three ticks ahead of the authoritative state, plus the margin
+    ASSERT_EQ(4U, fixture.seer.adaptiveHorizon.horizonTicks);
+    ASSERT_EQ(initialStepId + 1 + 4, fixture.seer.maxPredictionTickId);
+
+    horizonSetup.maxPredictionTimePerUpdate = 1;
+    seerSetAdaptiveHorizon(&fixture.seer, horizonSetup);
+    seerAdaptiveHorizonAddTickCost(&fixture.seer.adaptiveHorizon, 1000);
+    ASSERT_EQ(2U, fixture.seer.adaptiveHorizon.horizonTicks);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, gatheredStepIsPredicted)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    AppSpecificParticipantInput gameInput;
+    gameInput.horizontalAxis = 1;
+    const uint8_t* gameInputOctets = (const uint8_t*) &gameInput;
+
+    SeerPayloadFragment fragments[2];
+    fragments[0].octets = gameInputOctets;
+    fragments[0].octetCount = 2;
+    fragments[1].octets = gameInputOctets + 2;
+    fragments[1].octetCount = sizeof(gameInput) - 2;
+
+    SeerGatherParticipant participant;
+    participant.participantId = 1;
+    participant.localPartyId = 0;
+    participant.inputType = TransmuteParticipantInputTypeNormal;
+    participant.fragments = fragments;
+    participant.fragmentCount = 2;
+
+    ASSERT_EQ(0, seerAddPredictedStepGather(&fixture.seer, &participant, 1, initialStepId));
+
+    const TransmuteInput* stored = seerPredictedStepsGet(&fixture.seer.predictedSteps, initialStepId);
+    ASSERT_TRUE(stored != 0);
+    ASSERT_EQ(1U, stored->participantCount);
+    ASSERT_EQ(sizeof(gameInput), stored->participantInputs[0].octetSize);
+    ASSERT_EQ(0, tc_memcmp(stored->participantInputs[0].input, &gameInput, sizeof(gameInput)));
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(1, fixture.appSpecificVm.appSpecificState.x);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, predictedPayloadsAreReadFromRing)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    for (StepId i = 0; i < 3; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    const TransmuteInput* stored = seerGetPredictedInput(&fixture.seer, initialStepId + 2);
+    ASSERT_TRUE(stored != 0);
+    ASSERT_TRUE(fixture.appSpecificCallback.lastPredictedPayload == stored->participantInputs[0].input);
+    const uint8_t* arena = fixture.seer.predictedSteps.payloadArena;
+    const uint8_t* payload = (const uint8_t*) stored->participantInputs[0].input;
+    ASSERT_TRUE(payload >= arena && payload < arena + fixture.seer.predictedSteps.capacity *
+                                                          fixture.seer.predictedSteps.maxPayloadOctetCountPerStep);
+    ASSERT_TRUE(seerGetPredictedInput(&fixture.seer, initialStepId + 3) == 0);
+
+    // The fixture is set up without useParticipantInputsSoa, so there is no struct of arrays view
+    SeerParticipantInputsSoa soa;
+    ASSERT_TRUE(seerGetPredictedInputSoa(&fixture.seer, initialStepId + 2, &soa) < 0);
+    ASSERT_TRUE(fixture.seer.predictedSteps.soaPayloads == 0);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, payloadsAreAligned)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInitWithAlignment(&fixture, initialStepId, 0, 32);
+
+    uint8_t firstPayload[3] = {1, 2, 3};
+    uint8_t secondPayload[5] = {4, 5, 6, 7, 8};
+
+    TransmuteParticipantInput participantInputs[2];
+    participantInputs[0].participantId = 1;
+    participantInputs[0].localPartyId = 0;
+    participantInputs[0].inputType = TransmuteParticipantInputTypeNormal;
+    participantInputs[0].input = firstPayload;
+    participantInputs[0].octetSize = sizeof(firstPayload);
+    participantInputs[1] = participantInputs[0];
+    participantInputs[1].participantId = 2;
+    participantInputs[1].input = secondPayload;
+    participantInputs[1].octetSize = sizeof(secondPayload);
+
+    TransmuteInput input;
+    input.participantInputs = participantInputs;
+    input.participantCount = 2;
+
+    for (StepId i = 0; i < 3; ++i) {
+        ASSERT_EQ(0, seerAddPredictedStep(&fixture.seer, &input, initialStepId + i));
+        const TransmuteInput* stored = seerGetPredictedInput(&fixture.seer, initialStepId + i);
+        size_t firstRemainder = (size_t) (uintptr_t) stored->participantInputs[0].input % 32U;
+        size_t secondRemainder = (size_t) (uintptr_t) stored->participantInputs[1].input % 32U;
+        ASSERT_EQ(0U, firstRemainder);
+        ASSERT_EQ(0U, secondRemainder);
+        ASSERT_EQ(0, tc_memcmp(stored->participantInputs[1].input, secondPayload, sizeof(secondPayload)));
+    }
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, schedulerUpdatesAllSessions)
+{
+#define TEST_SCHEDULER_SESSION_COUNT (6)
+    static TestFixture fixtures[TEST_SCHEDULER_SESSION_COUNT];
+    StepId initialStepId = 101;
+
+    static SeerScheduler scheduler;
+    Clog schedulerLog;
+    schedulerLog.constantPrefix = "scheduler";
+    schedulerLog.config = &g_clog;
+
+    for (size_t i = 0; i < TEST_SCHEDULER_SESSION_COUNT; ++i) {
+        testFixtureInit(&fixtures[i], initialStepId);
+        for (StepId j = 0; j < (StepId) (i + 1); ++j) {
+            testFixtureAddPredictedStep(&fixtures[i], 1, initialStepId + j);
+        }
+    }
+
+    seerSchedulerInit(&scheduler, &fixtures[0].imprint.slabAllocator.info.allocator,
+                      &fixtures[0].imprint.slabAllocator.info, TEST_SCHEDULER_SESSION_COUNT, 3, schedulerLog);
+    for (size_t i = 0; i < TEST_SCHEDULER_SESSION_COUNT; ++i) {
+        ASSERT_EQ((int) i, seerSchedulerAdd(&scheduler, &fixtures[i].seer));
+    }
+    ASSERT_EQ(0, seerSchedulerStart(&scheduler));
+
+    seerSchedulerUpdate(&scheduler);
+    seerSchedulerUpdate(&scheduler);
+
+    for (size_t i = 0; i < TEST_SCHEDULER_SESSION_COUNT; ++i) {
+        ASSERT_EQ((int) (i + 1), fixtures[i].appSpecificVm.appSpecificState.x);
+        ASSERT_EQ(2U, scheduler.sessions[i].updateCount);
+        ASSERT_EQ(0, scheduler.sessions[i].lastUpdateResult);
+    }
+
+    seerSchedulerDestroy(&scheduler);
+
+    for (size_t i = 0; i < TEST_SCHEDULER_SESSION_COUNT; ++i) {
+        testFixtureDestroy(&fixtures[i]);
+    }
+#undef TEST_SCHEDULER_SESSION_COUNT
+}
+
+UTEST(Assent, speculativeBranchIsSelected)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInitWithSpeculation(&fixture, initialStepId, 4);
+
+    AppSpecificParticipantInput hypothesisInputs[2];
+    hypothesisInputs[0].horizontalAxis = 0;
+    hypothesisInputs[1].horizontalAxis = 1;
+    SeerPayloadFragment hypotheses[2];
+    for (size_t i = 0; i < 2; ++i) {
+        hypotheses[i].octets = &hypothesisInputs[i];
+        hypotheses[i].octetCount = sizeof(hypothesisInputs[i]);
+    }
+    ASSERT_EQ(0, seerSetSpeculation(&fixture.seer, 1, hypotheses, 2));
+
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(8, seerUpdateSpeculativeBranches(&fixture.seer));
+    ASSERT_EQ(4, fixture.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(0, fixture.appSpecificCallback.branchVms[0].appSpecificState.x);
+
+    // The participant did not walk, so the prediction was wrong, but the first branch was right
+    ASSERT_EQ(0, testFixtureConfirmStep(&fixture, 0, initialStepId));
+    ASSERT_EQ(0, testFixtureConfirmStep(&fixture, 0, initialStepId + 1));
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 2);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    ASSERT_EQ(0, fixture.appSpecificCallback.selectedBranchIndex);
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+    ASSERT_EQ(initialStepId + 4, fixture.seer.stepId);
+    ASSERT_EQ(0, fixture.appSpecificVm.appSpecificState.x);
+    ASSERT_EQ(4, fixture.appSpecificVm.appSpecificState.time);
+
+    // The ticks after the authoritative state are compared with the hypothesis of the selected branch
+    ASSERT_EQ(1, testFixtureConfirmStep(&fixture, 0, initialStepId + 2));
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, repeatedPayloadsAreShared)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerStats stats;
+    seerStatsInit(&stats);
+    seerSetStats(&fixture.seer, &stats);
+
+    for (StepId i = 0; i < 3; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    testFixtureAddPredictedStep(&fixture, 0, initialStepId + 3);
+
+    const void* firstPayload = seerGetPredictedInput(&fixture.seer, initialStepId)->participantInputs[0].input;
+    ASSERT_TRUE(seerGetPredictedInput(&fixture.seer, initialStepId + 1)->participantInputs[0].input == firstPayload);
+    ASSERT_TRUE(seerGetPredictedInput(&fixture.seer, initialStepId + 2)->participantInputs[0].input == firstPayload);
+    ASSERT_TRUE(seerGetPredictedInput(&fixture.seer, initialStepId + 3)->participantInputs[0].input != firstPayload);
+    ASSERT_EQ(2U * sizeof(AppSpecificParticipantInput), stats.sharedPayloadOctetCount);
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 1);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    // The payload was stored with the discarded step, so it is moved to the last step that still shares it
+    const SeerPredictedSteps* predictedSteps = &fixture.seer.predictedSteps;
+    const uint8_t* lastSlice = predictedSteps->payloadArena + ((initialStepId + 2) & predictedSteps->indexMask) *
+                                                                  predictedSteps->maxPayloadOctetCountPerStep;
+    const void* movedPayload = seerGetPredictedInput(&fixture.seer, initialStepId + 1)->participantInputs[0].input;
+    ASSERT_TRUE(movedPayload == lastSlice);
+    ASSERT_TRUE(seerGetPredictedInput(&fixture.seer, initialStepId + 2)->participantInputs[0].input == movedPayload);
+    ASSERT_EQ(1, ((const AppSpecificParticipantInput*) movedPayload)->horizontalAxis);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, replacingStepKeepsMovedSharedPayloads)
+{
+    ImprintDefaultSetup imprint;
+    imprintDefaultSetupInit(&imprint, 1024 * 1024);
+
+    Clog log;
+    log.constantPrefix = "predictedSteps";
+    log.config = &g_clog;
+
+    SeerPredictedSteps predictedSteps;
+    seerPredictedStepsInit(&predictedSteps, &imprint.slabAllocator.info.allocator, 16, 4, 8, 0, 0, false, log);
+
+    AppSpecificParticipantInput gameInput;
+    TransmuteParticipantInput participantInput;
+    participantInput.participantId = 1;
+    participantInput.localPartyId = 0;
+    participantInput.inputType = TransmuteParticipantInputTypeNormal;
+    participantInput.input = &gameInput;
+    participantInput.octetSize = sizeof(gameInput);
+
+    TransmuteInput input;
+    input.participantInputs = &participantInput;
+    input.participantCount = 1;
+
+    StepId initialStepId = 101;
+    gameInput.horizontalAxis = 1;
+    for (StepId i = 0; i < 6; ++i) {
+        ASSERT_EQ(0, seerPredictedStepsWrite(&predictedSteps, &input, initialStepId + i));
+    }
+
+    // The shared payload is moved forward when the step that stored it is discarded
+    seerPredictedStepsDiscardUpTo(&predictedSteps, initialStepId + 2);
+
+    gameInput.horizontalAxis = -1;
+    ASSERT_EQ(0, seerPredictedStepsWrite(&predictedSteps, &input, initialStepId + 5));
+
+    for (StepId i = 2; i < 6; ++i) {
+        const TransmuteInput* stored = seerPredictedStepsGet(&predictedSteps, initialStepId + i);
+        const AppSpecificParticipantInput* storedGameInput = (const AppSpecificParticipantInput*) stored
+                                                                 ->participantInputs[0]
+                                                                 .input;
+        ASSERT_EQ(i < 5 ? 1 : -1, storedGameInput->horizontalAxis);
+    }
+
+    seerPredictedStepsDestroy(&predictedSteps, &imprint.slabAllocator.info);
+}
+
+UTEST(Assent, participantInputsSoaMatchesInputs)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInitWithSoa(&fixture, initialStepId);
+
+    for (StepId i = 0; i < 3; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    seerAuthoritativeGotNewState(&fixture.seer, initialStepId + 1);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+
+    for (StepId i = 1; i < 3; ++i) {
+        const TransmuteInput* input = seerGetPredictedInput(&fixture.seer, initialStepId + i);
+        SeerParticipantInputsSoa soa;
+        ASSERT_EQ(0, seerGetPredictedInputSoa(&fixture.seer, initialStepId + i, &soa));
+        ASSERT_EQ(input->participantCount, soa.participantCount);
+        ASSERT_EQ(input->participantInputs[0].participantId, soa.participantIds[0]);
+        ASSERT_EQ(input->participantInputs[0].inputType, soa.inputTypes[0]);
+        ASSERT_TRUE(input->participantInputs[0].input == soa.payloads[0]);
+        ASSERT_EQ(input->participantInputs[0].octetSize, soa.octetSizes[0]);
+    }
+
+    SeerParticipantInputsSoa missing;
+    ASSERT_TRUE(seerGetPredictedInputSoa(&fixture.seer, initialStepId, &missing) < 0);
+
+    testFixtureDestroy(&fixture);
+}
+
+UTEST(Assent, resentStepIsNotDecodedAgain)
+{
+    TestFixture fixture;
+    StepId initialStepId = 101;
+    testFixtureInit(&fixture, initialStepId);
+
+    SeerStats stats;
+    seerStatsInit(&stats);
+    seerSetStats(&fixture.seer, &stats);
+
+    for (StepId i = 0; i < 3; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    size_t deserializedOctetCount = stats.deserializedOctetCount;
+
+    // The same steps are sent again, together with the next one
+    for (StepId i = 0; i < 4; ++i) {
+        testFixtureAddPredictedStep(&fixture, 1, initialStepId + i);
+    }
+    ASSERT_EQ(3U, stats.duplicateStepCount);
+    ASSERT_EQ(deserializedOctetCount * 4 / 3, stats.deserializedOctetCount);
+
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(1, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+    ASSERT_EQ(4, fixture.appSpecificCallback.predictTickCount);
+
+    // A step with other content of the same size for the same tick is still a correction
+    testFixtureAddPredictedStep(&fixture, 0, initialStepId + 1);
+    ASSERT_EQ(3U, stats.duplicateStepCount);
+    ASSERT_EQ(0, seerUpdate(&fixture.seer));
+    ASSERT_EQ(2, fixture.appSpecificCallback.copyFromAuthoritativeCount);
+
+    // A step that was added already decoded has no serialized step to compare with
+    AppSpecificParticipantInput gameInput;
+    gameInput.horizontalAxis = 1;
+    TransmuteParticipantInput participantInput;
+    participantInput.participantId = 1;
+    participantInput.localPartyId = 0;
+    participantInput.inputType = TransmuteParticipantInputTypeNormal;
+    participantInput.input = &gameInput;
+    participantInput.octetSize = sizeof(gameInput);
+    TransmuteInput input;
+    input.participantInputs = &participantInput;
+    input.participantCount = 1;
+    ASSERT_EQ(0, seerAddPredictedStep(&fixture.seer, &input, initialStepId + 2));
+    deserializedOctetCount = stats.deserializedOctetCount;
+    testFixtureAddPredictedStep(&fixture, 1, initialStepId + 2);
+    ASSERT_EQ(3U, stats.duplicateStepCount);
+    ASSERT_TRUE(stats.deserializedOctetCount > deserializedOctetCount);
+
+    testFixtureDestroy(&fixture);
+}